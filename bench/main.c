@@ -0,0 +1,594 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file bench/main.c
+ * @brief This file contains the microbenchmarks of the ARISr library (parse, build, partial functions, CRC and AES).
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h> // For malloc, free, strtoul
+#include <time.h>   // For clock_gettime
+
+#include "lib_arisr.h"
+
+// Largest list given to --dests, --from or --payloads
+#define BENCH_MAX_VALUES        4096
+
+// Time spent on each measurement unless --time is given, in milliseconds
+#define BENCH_DEFAULT_TIME_MS   20
+#define BENCH_QUICK_TIME_MS     1
+
+// Batches double until the time is spent, this bounds the time between two clock reads
+#define BENCH_MAX_BATCH         (1UL << 16)
+
+/**
+ * @brief Measured operations, in the order of the output.
+ */
+typedef enum {
+    kBENCH_PARSE = 0,
+    kBENCH_PARSE_REJECT,
+    kBENCH_VIEW,
+    kBENCH_BUILD,
+    kBENCH_RECV,
+    kBENCH_UNPACK,
+    kBENCH_PACK,
+    kBENCH_SEND,
+    kBENCH_CRC16,
+    kBENCH_AES_ENCRYPT,
+    kBENCH_AES_DECRYPT,
+    kBENCH_COUNT
+} BENCH_OP;
+
+static const char *BENCH_OP_NAMES[kBENCH_COUNT] = {
+    "parse",
+    "parse_reject",
+    "view",
+    "build",
+    "recv",
+    "unpack",
+    "pack",
+    "send",
+    "crc16",
+    "aes_encrypt",
+    "aes_decrypt",
+};
+
+/**
+ * @brief Inputs of every operation for one (destinations, from, payload) point.
+ */
+typedef struct {
+    ARISR_CHUNK chunk;                                          // Plain frame given to build and pack
+    ARISR_UINT8 *frame;                                         // Built frame given to parse, view and recv
+    ARISR_UINT8 *broken;                                        // Same frame with a bad header CRC, for parse_reject
+    ARISR_UINT32 frame_length;
+    ARISR_CHUNK_RAW received;                                   // Output of recv given to unpack
+    ARISR_CHUNK_RAW packed;                                     // Output of pack given to send
+    ARISR_UINT8 *cipher;                                        // Encrypted payload given to aes_decrypt
+    ARISR_UINT32 cipher_length;
+    ARISR_UINT32 payload_length;
+} BENCH_CASE;
+
+/**
+ * @brief Sweep and output settings from the command line.
+ */
+typedef struct {
+    ARISR_UINT32 dests[BENCH_MAX_VALUES];
+    ARISR_UINT32 dests_count;
+    ARISR_UINT32 from[BENCH_MAX_VALUES];
+    ARISR_UINT32 from_count;
+    ARISR_UINT32 payloads[BENCH_MAX_VALUES];
+    ARISR_UINT32 payloads_count;
+    ARISR_UINT8 ops[kBENCH_COUNT];                              // 1 for the operations to measure
+    ARISR_UINT32 time_ms;
+    ARISR_UINT8 json;
+    const char *output;
+} BENCH_CONFIG;
+
+static const ARISR_AES128_KEY BENCH_KEY = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static ARISR_UINT8 BENCH_ID[ARISR_PROTO_ID_SIZE] = { 0x01, 0x02, 0x03, 0x04 };
+
+static ARISR_UINT48 bench_destinations[ARISR_PROTO_MAX_DESTINATIONS];
+static ARISR_UINT8 bench_payload[ARISR_PROTO_MAX_FRAGMENT_SIZE];
+
+// Keeps the CRC results alive so the calls are not optimized away
+static volatile ARISR_UINT16 bench_sink;
+
+/* ===== TIMING ===== */
+
+// =============================================
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// =============================================
+static ARISR_ERR bench_run_once(BENCH_OP op, BENCH_CASE *c)
+{
+    ARISR_CHUNK chunk;
+    ARISR_CHUNK_RAW raw;
+    ARISR_FRAME_VIEW view;
+    ARISR_UINT8 *buffer = NULL;
+    ARISR_UINT32 length;
+    ARISR_ERR err = kARISR_OK;
+
+    switch (op) {
+        case kBENCH_PARSE:
+            memset(&chunk, 0, sizeof(chunk));
+            if ((err = ARISR_proto_parse(&chunk, c->frame, BENCH_KEY, BENCH_ID)) == kARISR_OK) {
+                ARISR_proto_chunk_clean(&chunk);
+            }
+            break;
+
+        case kBENCH_PARSE_REJECT:
+            // Dropped on the header, nothing is allocated and no key is expanded
+            memset(&chunk, 0, sizeof(chunk));
+            err = ARISR_proto_parse(&chunk, c->broken, BENCH_KEY, BENCH_ID);
+            err = err == kARISR_ERR_NOT_SAME_CRC_HEADER ? kARISR_OK : kARISR_ERR_GENERIC;
+            break;
+
+        case kBENCH_VIEW:
+            err = ARISR_proto_view(&view, c->frame, BENCH_KEY, BENCH_ID);
+            break;
+
+        case kBENCH_BUILD:
+            err = ARISR_proto_build(&buffer, &length, &c->chunk, BENCH_KEY);
+            free(buffer);
+            break;
+
+        case kBENCH_RECV:
+            memset(&raw, 0, sizeof(raw));
+            if ((err = ARISR_proto_recv(&raw, c->frame, BENCH_KEY, BENCH_ID)) == kARISR_OK) {
+                ARISR_proto_raw_chunk_clean(&raw);
+            }
+            break;
+
+        case kBENCH_UNPACK:
+            memset(&chunk, 0, sizeof(chunk));
+            if ((err = ARISR_proto_unpack(&chunk, &c->received, BENCH_KEY)) == kARISR_OK) {
+                ARISR_proto_chunk_clean(&chunk);
+            }
+            break;
+
+        case kBENCH_PACK:
+            memset(&raw, 0, sizeof(raw));
+            if ((err = ARISR_proto_pack(&raw, &c->chunk, BENCH_KEY)) == kARISR_OK) {
+                ARISR_proto_raw_chunk_clean(&raw);
+            }
+            break;
+
+        case kBENCH_SEND:
+            err = ARISR_proto_send(&buffer, &c->packed, &length);
+            free(buffer);
+            break;
+
+        case kBENCH_CRC16:
+            bench_sink ^= ARISR_crypt_crc16_calculate(bench_payload, c->payload_length);
+            break;
+
+        case kBENCH_AES_ENCRYPT:
+            err = ARISR_aes_data_encrypt(BENCH_KEY, bench_payload, c->payload_length, &buffer, &length);
+            free(buffer);
+            break;
+
+        case kBENCH_AES_DECRYPT:
+            err = ARISR_aes_data_decrypt(BENCH_KEY, c->cipher, c->cipher_length, &buffer, &length);
+            free(buffer);
+            break;
+
+        default:
+            err = kARISR_ERR_INVALID_ARGUMENT;
+            break;
+    }
+
+    return err;
+}
+
+// =============================================
+static ARISR_ERR bench_measure(BENCH_OP op, BENCH_CASE *c, double budget_ns, ARISR_UINT64 *iterations, double *elapsed_ns)
+{
+    ARISR_UINT64 count = 0;
+    ARISR_UINT32 batch = 1, n;
+    double start, elapsed = 0;
+    ARISR_ERR err;
+
+    // Warm up the caches and the allocator, and check the operation succeeds at all
+    if ((err = bench_run_once(op, c)) != kARISR_OK) {
+        return err;
+    }
+
+    start = bench_now_ns();
+    while (elapsed < budget_ns) {
+        for (n = 0; n < batch; n++) {
+            bench_run_once(op, c);
+        }
+        count  += batch;
+        elapsed = bench_now_ns() - start;
+
+        if (batch < BENCH_MAX_BATCH) {
+            batch <<= 1;
+        }
+    }
+
+    *iterations = count;
+    *elapsed_ns = elapsed;
+
+    return kARISR_OK;
+}
+
+/* ===== CASES ===== */
+
+// =============================================
+static void bench_case_clean(BENCH_CASE *c)
+{
+    free(c->frame);
+    free(c->broken);
+    free(c->cipher);
+    ARISR_proto_raw_chunk_clean(&c->received);
+    ARISR_proto_raw_chunk_clean(&c->packed);
+    memset(c, 0, sizeof(BENCH_CASE));
+}
+
+// =============================================
+static ARISR_ERR bench_case_init(BENCH_CASE *c, ARISR_UINT32 dests, ARISR_UINT32 from, ARISR_UINT32 payload)
+{
+    ARISR_ERR err;
+
+    memset(c, 0, sizeof(BENCH_CASE));
+    c->payload_length = payload;
+
+    memcpy(c->chunk.id, BENCH_ID, ARISR_PROTO_ID_SIZE);
+    memcpy(c->chunk.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+    memset(c->chunk.origin, 0xA1, ARISR_ADDRESS_SIZE);
+    memset(c->chunk.destinationA, 0xB2, ARISR_ADDRESS_SIZE);
+    memset(c->chunk.destinationC, 0xC3, ARISR_ADDRESS_SIZE);
+    c->chunk.ctrl.destinations  = (ARISR_UINT8)dests;
+    c->chunk.ctrl.from          = (ARISR_UINT8)from;
+    c->chunk.ctrl.more_header   = 1;
+    c->chunk.destinationsB      = dests ? bench_destinations : NULL;
+    c->chunk.ctrl2.data_length  = payload;
+    c->chunk.data               = payload ? bench_payload : NULL;
+
+    // The frame and the intermediate structures are made once, outside of the timed loops
+    if ((err = ARISR_proto_build(&c->frame, &c->frame_length, &c->chunk, BENCH_KEY)) != kARISR_OK ||
+        (err = ARISR_proto_recv(&c->received, c->frame, BENCH_KEY, BENCH_ID)) != kARISR_OK ||
+        (err = ARISR_proto_pack(&c->packed, &c->chunk, BENCH_KEY)) != kARISR_OK) {
+        bench_case_clean(c);
+        return err;
+    }
+
+    // One bit of the origin flipped, so the header CRC no longer matches
+    if (!(c->broken = (ARISR_UINT8 *)malloc(c->frame_length))) {
+        bench_case_clean(c);
+        return kARISR_ERR_GENERIC;
+    }
+    memcpy(c->broken, c->frame, c->frame_length);
+    c->broken[ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE] ^= 0x01;
+
+    if (payload > 0 && (err = ARISR_aes_data_encrypt(BENCH_KEY, bench_payload, payload, &c->cipher, &c->cipher_length)) != kARISR_OK) {
+        bench_case_clean(c);
+        return err;
+    }
+
+    return kARISR_OK;
+}
+
+/* ===== OUTPUT ===== */
+
+// =============================================
+static void bench_output_begin(FILE *out, const BENCH_CONFIG *config)
+{
+    if (config->json) {
+        fprintf(out, "{\n  \"time_ms\": %u,\n  \"results\": [", config->time_ms);
+    } else {
+        fprintf(out, "operation,destinations,from,payload,bytes,iterations,ns_per_frame,frames_per_s\n");
+    }
+}
+
+// =============================================
+static void bench_output_row(FILE *out, const BENCH_CONFIG *config, ARISR_UINT8 first, BENCH_OP op, ARISR_UINT32 dests, ARISR_UINT32 from,
+                             ARISR_UINT32 payload, ARISR_UINT32 bytes, ARISR_UINT64 iterations, double elapsed_ns)
+{
+    double ns_per_frame = elapsed_ns / (double)iterations;
+    double frames_per_s = 1e9 / ns_per_frame;
+
+    if (config->json) {
+        fprintf(out, "%s\n    {\"operation\": \"%s\", \"destinations\": %u, \"from\": %u, \"payload\": %u, \"bytes\": %u, "
+                     "\"iterations\": %llu, \"ns_per_frame\": %.1f, \"frames_per_s\": %.0f}",
+                first ? "" : ",", BENCH_OP_NAMES[op], dests, from, payload, bytes, (unsigned long long)iterations, ns_per_frame, frames_per_s);
+    } else {
+        fprintf(out, "%s,%u,%u,%u,%u,%llu,%.1f,%.0f\n",
+                BENCH_OP_NAMES[op], dests, from, payload, bytes, (unsigned long long)iterations, ns_per_frame, frames_per_s);
+    }
+}
+
+// =============================================
+static void bench_output_end(FILE *out, const BENCH_CONFIG *config)
+{
+    if (config->json) {
+        fprintf(out, "\n  ]\n}\n");
+    }
+}
+
+/* ===== COMMAND LINE ===== */
+
+// =============================================
+static void bench_usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --dests LIST     Destination counts, 0 to %u (default 0,1,4,16,64,255)\n"
+            "  --from LIST      Relayed frames off/on, 0 or 1 (default 0,1)\n"
+            "  --payloads LIST  Payload sizes, 0 to %u bytes (default 0,16,64,256,1024,%u)\n"
+            "  --ops LIST       Operations among parse,parse_reject,view,build,recv,unpack,pack,send,\n"
+            "                   crc16,aes_encrypt,aes_decrypt (default all)\n"
+            "  --time MS        Time spent on each measurement (default %u)\n"
+            "  --quick          Same as --time %u, to check that everything runs\n"
+            "  --format FORMAT  csv or json (default csv)\n"
+            "  --output FILE    Write the results to FILE instead of stdout\n"
+            "LIST is a comma separated list of values or of ranges 'first:last[:step]', e.g. 0:255:17,255\n",
+            name, ARISR_PROTO_MAX_DESTINATIONS, ARISR_PROTO_MAX_FRAGMENT_SIZE, ARISR_PROTO_MAX_FRAGMENT_SIZE,
+            BENCH_DEFAULT_TIME_MS, BENCH_QUICK_TIME_MS);
+}
+
+// =============================================
+static int bench_parse_list(const char *text, ARISR_UINT32 max, ARISR_UINT32 *values, ARISR_UINT32 *count)
+{
+    unsigned long first, last, step, v;
+    char *end;
+
+    *count = 0;
+
+    for (;;) {
+        first = strtoul(text, &end, 10);
+        if (end == text) {
+            return -1;
+        }
+        last = first;
+        step = 1;
+
+        if (*end == ':') {
+            text = end + 1;
+            last = strtoul(text, &end, 10);
+            if (end == text || last < first) {
+                return -1;
+            }
+            if (*end == ':') {
+                text = end + 1;
+                step = strtoul(text, &end, 10);
+                if (end == text || step == 0) {
+                    return -1;
+                }
+            }
+        }
+
+        if (last > max) {
+            return -1;
+        }
+        for (v = first; v <= last; v += step) {
+            if (*count >= BENCH_MAX_VALUES) {
+                return -1;
+            }
+            values[(*count)++] = (ARISR_UINT32)v;
+        }
+
+        if (*end == '\0') {
+            return 0;
+        }
+        if (*end != ',') {
+            return -1;
+        }
+        text = end + 1;
+    }
+}
+
+// =============================================
+static int bench_parse_ops(const char *text, ARISR_UINT8 *ops)
+{
+    size_t length;
+    int op;
+
+    memset(ops, 0, kBENCH_COUNT);
+
+    while (*text) {
+        length = strcspn(text, ",");
+        for (op = 0; op < kBENCH_COUNT; op++) {
+            if (strlen(BENCH_OP_NAMES[op]) == length && strncmp(text, BENCH_OP_NAMES[op], length) == 0) {
+                ops[op] = 1;
+                break;
+            }
+        }
+        if (op == kBENCH_COUNT) {
+            return -1;
+        }
+        text += length;
+        if (*text == ',') {
+            text++;
+        }
+    }
+
+    return 0;
+}
+
+// =============================================
+static int bench_parse_args(int argc, char **argv, BENCH_CONFIG *config)
+{
+    int i, err = 0;
+
+    memset(config, 0, sizeof(BENCH_CONFIG));
+    bench_parse_list("0,1,4,16,64,255", ARISR_PROTO_MAX_DESTINATIONS, config->dests, &config->dests_count);
+    bench_parse_list("0,1", 1, config->from, &config->from_count);
+    bench_parse_list("0,16,64,256,1024,2031", ARISR_PROTO_MAX_FRAGMENT_SIZE, config->payloads, &config->payloads_count);
+    memset(config->ops, 1, kBENCH_COUNT);
+    config->time_ms = BENCH_DEFAULT_TIME_MS;
+
+    for (i = 1; i < argc && err == 0; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            config->time_ms = BENCH_QUICK_TIME_MS;
+        } else if (i + 1 >= argc) {
+            err = -1;
+        } else if (strcmp(argv[i], "--dests") == 0) {
+            err = bench_parse_list(argv[++i], ARISR_PROTO_MAX_DESTINATIONS, config->dests, &config->dests_count);
+        } else if (strcmp(argv[i], "--from") == 0) {
+            err = bench_parse_list(argv[++i], 1, config->from, &config->from_count);
+        } else if (strcmp(argv[i], "--payloads") == 0) {
+            err = bench_parse_list(argv[++i], ARISR_PROTO_MAX_FRAGMENT_SIZE, config->payloads, &config->payloads_count);
+        } else if (strcmp(argv[i], "--ops") == 0) {
+            err = bench_parse_ops(argv[++i], config->ops);
+        } else if (strcmp(argv[i], "--time") == 0) {
+            config->time_ms = (ARISR_UINT32)strtoul(argv[++i], NULL, 10);
+            err = config->time_ms == 0 ? -1 : 0;
+        } else if (strcmp(argv[i], "--format") == 0) {
+            i++;
+            config->json = strcmp(argv[i], "json") == 0;
+            err = config->json || strcmp(argv[i], "csv") == 0 ? 0 : -1;
+        } else if (strcmp(argv[i], "--output") == 0) {
+            config->output = argv[++i];
+        } else {
+            err = -1;
+        }
+    }
+
+    return err;
+}
+
+/* ===== MAIN ===== */
+
+// =============================================
+int main(int argc, char **argv)
+{
+    BENCH_CONFIG *config;
+    BENCH_CASE c;
+    FILE *out = stdout;
+    ARISR_UINT64 iterations;
+    ARISR_UINT32 d, f, p, op, bytes;
+    ARISR_UINT8 first = 1;
+    double budget_ns, elapsed_ns;
+    ARISR_ERR err;
+    int rc = 0;
+
+    config = (BENCH_CONFIG *)malloc(sizeof(BENCH_CONFIG));
+    if (!config) {
+        return 1;
+    }
+    if (bench_parse_args(argc, argv, config) != 0) {
+        bench_usage(argv[0]);
+        free(config);
+        return 2;
+    }
+
+    if (config->output && !(out = fopen(config->output, "w"))) {
+        fprintf(stderr, "Cannot open %s\n", config->output);
+        free(config);
+        return 1;
+    }
+
+    // Distinct non-zero addresses and a payload that is not all zeros
+    for (d = 0; d < ARISR_PROTO_MAX_DESTINATIONS; d++) {
+        memset(bench_destinations[d], 0x10, ARISR_ADDRESS_SIZE);
+        bench_destinations[d][ARISR_ADDRESS_SIZE - 1] = (ARISR_UINT8)(d + 1);
+    }
+    for (p = 0; p < sizeof(bench_payload); p++) {
+        bench_payload[p] = (ARISR_UINT8)(p * 31 + 7);
+    }
+
+    budget_ns = (double)config->time_ms * 1e6;
+    bench_output_begin(out, config);
+
+    // Frame operations, over the whole sweep
+    for (d = 0; d < config->dests_count && rc == 0; d++) {
+        for (f = 0; f < config->from_count && rc == 0; f++) {
+            for (p = 0; p < config->payloads_count && rc == 0; p++) {
+                if ((err = bench_case_init(&c, config->dests[d], config->from[f], config->payloads[p])) != kARISR_OK) {
+                    fprintf(stderr, "Cannot prepare destinations = %u from = %u payload = %u, error = %d (%s)\n",
+                            config->dests[d], config->from[f], config->payloads[p], err, ARISR_ERR_NAMES[err]);
+                    rc = 1;
+                    break;
+                }
+
+                for (op = kBENCH_PARSE; op <= kBENCH_SEND && rc == 0; op++) {
+                    if (!config->ops[op]) {
+                        continue;
+                    }
+                    if ((err = bench_measure((BENCH_OP)op, &c, budget_ns, &iterations, &elapsed_ns)) != kARISR_OK) {
+                        fprintf(stderr, "%s failed with error = %d (%s)\n", BENCH_OP_NAMES[op], err, ARISR_ERR_NAMES[err]);
+                        rc = 1;
+                        break;
+                    }
+                    bench_output_row(out, config, first, (BENCH_OP)op, config->dests[d], config->from[f], config->payloads[p],
+                                     c.frame_length, iterations, elapsed_ns);
+                    first = 0;
+                }
+
+                bench_case_clean(&c);
+            }
+        }
+    }
+
+    // CRC and AES only depend on the payload size, and need at least one byte
+    for (p = 0; p < config->payloads_count && rc == 0; p++) {
+        if (config->payloads[p] == 0) {
+            continue;
+        }
+        if ((err = bench_case_init(&c, 0, 0, config->payloads[p])) != kARISR_OK) {
+            fprintf(stderr, "Cannot prepare payload = %u, error = %d (%s)\n", config->payloads[p], err, ARISR_ERR_NAMES[err]);
+            rc = 1;
+            break;
+        }
+
+        for (op = kBENCH_CRC16; op <= kBENCH_AES_DECRYPT && rc == 0; op++) {
+            if (!config->ops[op]) {
+                continue;
+            }
+            if ((err = bench_measure((BENCH_OP)op, &c, budget_ns, &iterations, &elapsed_ns)) != kARISR_OK) {
+                fprintf(stderr, "%s failed with error = %d (%s)\n", BENCH_OP_NAMES[op], err, ARISR_ERR_NAMES[err]);
+                rc = 1;
+                break;
+            }
+            bytes = op == kBENCH_AES_DECRYPT ? c.cipher_length : c.payload_length;
+            bench_output_row(out, config, first, (BENCH_OP)op, 0, 0, config->payloads[p], bytes, iterations, elapsed_ns);
+            first = 0;
+        }
+
+        bench_case_clean(&c);
+    }
+
+    bench_output_end(out, config);
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(config);
+
+    return rc;
+}
+
+/* COPYRIGHT ARIS Alliance */
@@ -34,8 +34,25 @@
 #include "lib_arisr_comm.h"
 #include "lib_arisr_err.h"
 #include "lib_arisr_crypt.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_batch.h"
+#include "lib_arisr_pool.h"
+#include "lib_arisr_scan.h"
+#include "lib_arisr_reasm.h"
+#include "lib_arisr_dedup.h"
+#include "lib_arisr_addr.h"
 #include "lib_arisr.h"
 
+/*
+ * Thread safety: every function of the library is reentrant. The only shared data
+ * are const tables (AES, CRC, ARISR_DEFAULT_NULL_KEY, ARISR_DEFAULT_ALLOCATOR) and the
+ * CPU feature checks, cached with atomic loads and stores. Buffers, arenas, batches and
+ * static chunks are not synchronized: a thread must not share them while writing.
+ * An ARISR_KEY_CTX is read-only once initialized with ARISR_aes_key_ctx_init and can be
+ * shared (a lazy one from ARISR_aes_key_ctx_lazy cannot), and an ARISR_DEDUP is
+ * lock-free and meant to be shared by every ingest thread.
+ */
+
 /**
  * @brief Cleans (resets) the raw chunk buffer, freeing any allocated memory.
  */
@@ -54,6 +71,24 @@
         return err_code; \
     } while (0)
 
+/**
+ * @brief Same as ARISR_RAW_CLEAN_AND_RETURN, releasing the memory through 'allocator'.
+ */
+#define ARISR_RAW_CLEAN_ALLOC_AND_RETURN(err_code) \
+    do { \
+        ARISR_proto_raw_chunk_clean_alloc(buffer, allocator); \
+        return err_code; \
+    } while (0)
+
+/**
+ * @brief Same as ARISR_CLEAN_AND_RETURN, releasing the memory through 'allocator'.
+ */
+#define ARISR_CLEAN_ALLOC_AND_RETURN(err_code) \
+    do { \
+        ARISR_proto_chunk_clean_alloc(buffer, allocator); \
+        return err_code; \
+    } while (0)
+
 
 /**
  * @brief Cleans (resets) the raw chunk buffer, freeing any allocated memory.
@@ -71,6 +106,26 @@ ARISR_ERR ARISR_proto_raw_chunk_clean(ARISR_CHUNK_RAW *buffer);
  */
 ARISR_ERR ARISR_proto_chunk_clean(ARISR_CHUNK *buffer);
 
+/**
+ * @brief Same as ARISR_proto_raw_chunk_clean, for a buffer filled through 'allocator'.
+ *
+ * @param buffer    Pointer to the ARISR_CHUNK_RAW structure.
+ * @param allocator Allocator the fields were taken from.
+ * @return kARISR_OK on success, or kARISR_ERR_GENERIC if a parameter is NULL.
+ */
+ARISR_ERR ARISR_proto_raw_chunk_clean_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Same as ARISR_proto_chunk_clean, for a buffer filled through 'allocator'.
+ *
+ * With an arena allocator this only resets the structure, the memory goes back with ARISR_arena_reset.
+ *
+ * @param buffer    Pointer to the ARISR_CHUNK structure.
+ * @param allocator Allocator the fields were taken from.
+ * @return kARISR_OK on success, or kARISR_ERR_GENERIC if a parameter is NULL.
+ */
+ARISR_ERR ARISR_proto_chunk_clean_alloc(ARISR_CHUNK *buffer, const ARISR_ALLOCATOR *allocator);
+
 /**
  * @brief Retrieves specific bits from a 32-bit control structure, using offset and mask.
  *
@@ -107,6 +162,63 @@ ARISR_ERR ARISR_proto_ctrl_setField(ARISR_UINT8 *ctrl, ARISR_UINT8 data, ARISR_U
  */
 ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
 
+/**
+ * @brief Length-bounded version of ARISR_proto_parse.
+ *
+ * The expected frame size is computed from CTRL1/CTRL2 right after reading the first
+ * 12 bytes, and short or oversized frames are rejected before any CRC, copy or allocation.
+ *
+ * @param buffer [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param key    [in]  The AES-128 key used to decrypt the 'aris' section.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_parse.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *buffer. With ARISR_proto_chunk_clean.
+ */
+ARISR_ERR ARISR_proto_parse_len(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
+/**
+ * @brief Computes the exact size of the frame ARISR_proto_build would produce.
+ *
+ * The size follows from CTRL1 (destinations, from, more header) and the plain
+ * data length, padded to the next AES block as PKCS#7 does. Nothing is encrypted.
+ *
+ * @param data   [in]  Pointer to the struct output data buffer (e.g., from the sys).
+ * @param length [out] Size of the frame in bytes.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT if the padded data does not
+ *         fit in the CTRL2 data length field, or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_proto_frame_size(const ARISR_CHUNK *data, ARISR_UINT32 *length);
+
+/**
+ * @brief Computes the size of a frame from its raw CTRL1 and CTRL2 sections.
+ *
+ * Useful on the receive side to know how many bytes a frame still needs once
+ * its header has arrived.
+ *
+ * @param ctrl   [in]  Pointer to the 4 bytes of CTRL1.
+ * @param ctrl2  [in]  Pointer to the 4 bytes of CTRL2, may be NULL if 'more header' is not set.
+ * @param length [out] Size of the frame in bytes.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT if CTRL2 is required and missing,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_proto_frame_size_raw(const ARISR_UINT8 *ctrl, const ARISR_UINT8 *ctrl2, ARISR_UINT32 *length);
+
+/**
+ * @brief Computes the number of bytes covered by the header CRC from the raw CTRL1 section.
+ *
+ * When 'more header' is set, CTRL2 is the last section of the header and starts
+ * at 'length - ARISR_CTRL2_SECTION_SIZE'.
+ *
+ * @param ctrl   [in]  Pointer to the 4 bytes of CTRL1.
+ * @param length [out] Size of the header in bytes, without the CRC header.
+ * @return kARISR_OK on success, or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_proto_header_size_raw(const ARISR_UINT8 *ctrl, ARISR_UINT32 *length);
+
 /**
  * @brief Prepare and send from ARISR_CHUNK structure to a raw data.
  *
@@ -123,6 +235,419 @@ ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const
  */
 ARISR_ERR ARISR_proto_build(ARISR_UINT8 **buffer, ARISR_UINT32 *length, ARISR_CHUNK *data, const ARISR_AES128_KEY key);
 
+/**
+ * @brief Build a raw frame from an ARISR_CHUNK structure into a caller-supplied buffer.
+ *
+ * The exact frame size is computed first, then the header is written and the data section
+ * is padded, encrypted and its CRC calculated directly in its final place. No heap memory is used.
+ *
+ * @param buffer   [out] Pointer to the output buffer.
+ * @param capacity [in]  Size of the output buffer.
+ * @param length   [out] Size of the frame (also set when the buffer is too small).
+ * @param data     [in]  Pointer to the struct output data buffer (e.g., from the sys).
+ * @param key      [in]  The AES-128 key used to encrypt the data section.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'capacity' is smaller than the frame,
+ *         or an error code for invalid parameters.
+ */
+ARISR_ERR ARISR_proto_build_into(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_AES128_KEY key);
+
+/**
+ * @brief Validates a raw frame in place and describes it with an ARISR_FRAME_VIEW.
+ *
+ * This function performs the same checks as ARISR_proto_parse (ID, ARIS, CRC header,
+ * CRC data and END) but it does not copy, allocate or decrypt anything. The view
+ * points into 'data', so the caller can filter the frame by address or identifier
+ * before paying for the decryption with ARISR_proto_view_decrypt.
+ *
+ * @param view [out] Pointer to the ARISR_FRAME_VIEW to fill.
+ * @param data [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param key  [in]  The AES-128 key used to decrypt the 'aris' section.
+ * @param id   [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, or an error code for invalid parameters, CRC mismatch, etc.
+ *
+ * @note The view is only valid while 'data' is alive and unmodified.
+ */
+ARISR_ERR ARISR_proto_view(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
+/**
+ * @brief Length-bounded version of ARISR_proto_view.
+ *
+ * @param view   [out] Pointer to the ARISR_FRAME_VIEW to fill.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param key    [in]  The AES-128 key used to decrypt the 'aris' section.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_view.
+ */
+ARISR_ERR ARISR_proto_view_len(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
+/**
+ * @brief Decrypts the data section of a frame previously validated by ARISR_proto_view.
+ *
+ * @param view   [in]  Pointer to the ARISR_FRAME_VIEW describing the frame.
+ * @param key    [in]  The AES-128 key used to decrypt the data section.
+ * @param output [out] Decrypted data buffer, NULL if the frame has no data.
+ * @param length [out] Length of the decrypted data (excluding padding).
+ * @return kARISR_OK on success, or an error code for invalid parameters, padding, etc.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *output.
+ */
+ARISR_ERR ARISR_proto_view_decrypt(const ARISR_FRAME_VIEW *view, const ARISR_AES128_KEY key, ARISR_UINT8 **output, ARISR_UINT32 *length);
+
+/**
+ * @brief Decrypts the data section of a viewed frame into a caller-supplied buffer.
+ *
+ * No heap memory is used. 'output' may point into the receive buffer itself, e.g.
+ * at 'frame + view->data_offset', to decrypt the frame in place.
+ *
+ * @param view     [in]  Pointer to the ARISR_FRAME_VIEW describing the frame.
+ * @param key      [in]  The AES-128 key used to decrypt the data section.
+ * @param output   [out] Buffer receiving the decrypted data.
+ * @param capacity [in]  Size of 'output', view->ctrl2.data_length is always enough.
+ * @param length   [out] Length of the decrypted data (excluding padding), 0 if the frame has no data.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'output' is too small,
+ *         or an error code for invalid parameters, padding, etc.
+ */
+ARISR_ERR ARISR_proto_view_decrypt_into(const ARISR_FRAME_VIEW *view, const ARISR_AES128_KEY key, ARISR_UINT8 *output, ARISR_UINT32 capacity, ARISR_UINT32 *length);
+
+/* ===== PRE-EXPANDED KEY VARIANTS ===== */
+// The functions below take an ARISR_KEY_CTX built once with ARISR_aes_key_ctx_init,
+// so the AES key expansion is not repeated for every frame. The key based
+// functions above use these ones with a lazy context, which expands the key
+// only when a payload is actually encrypted or decrypted.
+
+/**
+ * @brief Same as ARISR_proto_parse, with a pre-expanded key.
+ *
+ * @param buffer [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, or an error code for invalid parameters, CRC mismatch, etc.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *buffer. With ARISR_proto_chunk_clean.
+ */
+ARISR_ERR ARISR_proto_parse_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_parse_len, with a pre-expanded key.
+ *
+ * @param buffer [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_parse.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *buffer. With ARISR_proto_chunk_clean.
+ */
+ARISR_ERR ARISR_proto_parse_len_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_build, with a pre-expanded key.
+ *
+ * @param buffer [out] Pointer to the raw output data buffer.
+ * @param length [out] Pointer to the size of the raw data buffer.
+ * @param data   [in]  Pointer to the struct output data buffer (e.g., from the sys).
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @return kARISR_OK on success, or an error code for invalid parameters.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *buffer.
+ */
+ARISR_ERR ARISR_proto_build_ctx(ARISR_UINT8 **buffer, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx);
+
+/**
+ * @brief Same as ARISR_proto_build_into, with a pre-expanded key.
+ *
+ * @param buffer   [out] Pointer to the output buffer.
+ * @param capacity [in]  Size of the output buffer.
+ * @param length   [out] Size of the frame (also set when the buffer is too small).
+ * @param data     [in]  Pointer to the struct output data buffer (e.g., from the sys).
+ * @param ctx      [in]  Key context from ARISR_aes_key_ctx_init.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'capacity' is smaller than the frame,
+ *         or an error code for invalid parameters.
+ */
+ARISR_ERR ARISR_proto_build_into_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx);
+
+/**
+ * @brief Same as ARISR_proto_view, with a pre-expanded key.
+ *
+ * @param view [out] Pointer to the ARISR_FRAME_VIEW to fill.
+ * @param data [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param ctx  [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id   [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, or an error code for invalid parameters, CRC mismatch, etc.
+ */
+ARISR_ERR ARISR_proto_view_ctx(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_view_len, with a pre-expanded key.
+ *
+ * @param view   [out] Pointer to the ARISR_FRAME_VIEW to fill.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_view.
+ */
+ARISR_ERR ARISR_proto_view_len_ctx(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_view_decrypt, with a pre-expanded key.
+ *
+ * @param view   [in]  Pointer to the ARISR_FRAME_VIEW describing the frame.
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param output [out] Decrypted data buffer, NULL if the frame has no data.
+ * @param length [out] Length of the decrypted data (excluding padding).
+ * @return kARISR_OK on success, or an error code for invalid parameters, padding, etc.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *output.
+ */
+ARISR_ERR ARISR_proto_view_decrypt_ctx(const ARISR_FRAME_VIEW *view, const ARISR_KEY_CTX *ctx, ARISR_UINT8 **output, ARISR_UINT32 *length);
+
+/**
+ * @brief Same as ARISR_proto_view_decrypt_into, with a pre-expanded key.
+ *
+ * @param view     [in]  Pointer to the ARISR_FRAME_VIEW describing the frame.
+ * @param ctx      [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param output   [out] Buffer receiving the decrypted data.
+ * @param capacity [in]  Size of 'output'.
+ * @param length   [out] Length of the decrypted data (excluding padding).
+ * @return kARISR_OK on success, or the same error codes as ARISR_proto_view_decrypt_into.
+ */
+ARISR_ERR ARISR_proto_view_decrypt_into_ctx(const ARISR_FRAME_VIEW *view, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *output, ARISR_UINT32 capacity, ARISR_UINT32 *length);
+
+/* ===== ALLOCATOR VARIANTS ===== */
+// The functions below take the variable-size fields (destinationsB, data, ...) from
+// 'allocator' instead of malloc. With an ARISR_ARENA, a whole batch of chunks is released
+// by a single ARISR_arena_reset and worker threads never contend on the heap.
+
+/**
+ * @brief Same as ARISR_proto_parse_ctx, allocating through 'allocator'.
+ *
+ * @param buffer    [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data      [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param ctx       [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id        [in]  The expected Network ID section to match the incoming data.
+ * @param allocator [in]  Allocator for the variable-size fields.
+ * @return kARISR_OK on success, or the same error codes as ARISR_proto_parse.
+ *
+ * @note Release the buffer with ARISR_proto_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_parse_ctx_alloc(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Same as ARISR_proto_parse_len_ctx, allocating through 'allocator'.
+ *
+ * @param buffer    [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data      [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length    [in]  Number of bytes available in 'data'.
+ * @param ctx       [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id        [in]  The expected Network ID section to match the incoming data.
+ * @param allocator [in]  Allocator for the variable-size fields.
+ * @return kARISR_OK on success, or the same error codes as ARISR_proto_parse_len.
+ *
+ * @note Release the buffer with ARISR_proto_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_parse_len_ctx_alloc(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator);
+
+/* ===== FIXED-CAPACITY CHUNK ===== */
+// ARISR_CHUNK_STATIC keeps destinationsB and data inline (see ARISR_STATIC_MAX_DESTINATIONS and
+// ARISR_STATIC_MAX_DATA_LENGTH), so the functions below never touch the heap and the chunks can
+// live in preallocated pools. There is nothing to clean.
+
+/**
+ * @brief Parses and decrypts a frame into an ARISR_CHUNK_STATIC.
+ *
+ * @param buffer [out] Chunk to fill.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param key    [in]  The AES-128 key used to decrypt the 'aris' and data sections.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if the frame exceeds the static
+ *         capacity, or the same error codes as ARISR_proto_parse.
+ */
+ARISR_ERR ARISR_proto_parse_static(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
+/**
+ * @brief Length-bounded version of ARISR_proto_parse_static.
+ *
+ * @param buffer [out] Chunk to fill.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param key    [in]  The AES-128 key used to decrypt the 'aris' and data sections.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_parse_static.
+ */
+ARISR_ERR ARISR_proto_parse_len_static(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
+/**
+ * @brief Builds a frame from an ARISR_CHUNK_STATIC into a caller-supplied buffer.
+ *
+ * @param buffer   [out] Output buffer, ARISR_PROTO_MAX_FRAME_SIZE is always enough.
+ * @param capacity [in]  Size of 'buffer'.
+ * @param length   [out] Length of the frame written.
+ * @param data     [in]  Chunk to encode.
+ * @param key      [in]  The AES-128 key used to encrypt the 'aris' and data sections.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT if the chunk exceeds the static
+ *         capacity, or the same error codes as ARISR_proto_build_into.
+ */
+ARISR_ERR ARISR_proto_build_static(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK_STATIC *data, const ARISR_AES128_KEY key);
+
+/**
+ * @brief Same as ARISR_proto_parse_static, with a pre-expanded key.
+ */
+ARISR_ERR ARISR_proto_parse_static_ctx(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_parse_len_static, with a pre-expanded key.
+ */
+ARISR_ERR ARISR_proto_parse_len_static_ctx(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+/**
+ * @brief Same as ARISR_proto_build_static, with a pre-expanded key.
+ */
+ARISR_ERR ARISR_proto_build_static_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK_STATIC *data, const ARISR_KEY_CTX *ctx);
+
+/* ===== FRAGMENTED MESSAGES ===== */
+// Largest plain payload of one frame: PKCS#7 always adds at least one byte of padding
+#define ARISR_PROTO_MAX_FRAGMENT_SIZE   ((ARISR_PROTO_MAX_DATA_LENGTH / ARISR_AES128_BLOCK_SIZE) * ARISR_AES128_BLOCK_SIZE - 1)
+
+// One fragment per value of the 6-bit sequence
+#define ARISR_PROTO_MAX_FRAGMENTS       (1 << ARISR_CTRL_SEQUENCE_BITS)
+
+/**
+ * @brief Splits a payload into a more_data sequence, built back to back into one buffer.
+ *
+ * Fragment 'k' carries payload[k * fragment_size, (k + 1) * fragment_size) with every
+ * header field of 'header' (id, aris, addresses, identifier, ...), sequence 'k' and more_data set
+ * on all but the last one. 'header->data' and 'header->ctrl2.data_length' are ignored.
+ * Nothing is allocated: every frame is encrypted straight into 'buffer'.
+ *
+ * @param buffer         [out] Output buffer for all the frames.
+ * @param capacity       [in]  Size of 'buffer'.
+ * @param header         [in]  Template of the header section shared by every fragment.
+ * @param payload        [in]  Message to send.
+ * @param payload_length [in]  Number of bytes in 'payload', 0 builds a single frame without data.
+ * @param fragment_size  [in]  Payload bytes per frame, 1 to ARISR_PROTO_MAX_FRAGMENT_SIZE.
+ * @param offsets        [out] Start of fragment 'k' in offsets[k], and the total length in offsets[count].
+ *                             It must hold 'max_fragments' + 1 entries.
+ * @param max_fragments  [in]  Fragments the caller can take, at most ARISR_PROTO_MAX_FRAGMENTS are sent.
+ * @param count          [out] Number of fragments of the message.
+ * @param ctx            [in]  Key context from ARISR_aes_key_ctx_init.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'capacity' is smaller than all the frames
+ *         (nothing is written, offsets[count] holds the size needed), kARISR_ERR_INVALID_ARGUMENT if
+ *         'fragment_size' is out of range or the message needs more than 'max_fragments' fragments,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_proto_build_fragments_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, const ARISR_CHUNK *header,
+                                          const ARISR_UINT8 *payload, ARISR_UINT32 payload_length, ARISR_UINT32 fragment_size,
+                                          ARISR_UINT32 offsets[], ARISR_UINT32 max_fragments, ARISR_UINT32 *count, const ARISR_KEY_CTX *ctx);
+
+/**
+ * @brief Same as ARISR_proto_build_fragments_ctx, the key is expanded once for all the fragments.
+ */
+ARISR_ERR ARISR_proto_build_fragments(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, const ARISR_CHUNK *header,
+                                      const ARISR_UINT8 *payload, ARISR_UINT32 payload_length, ARISR_UINT32 fragment_size,
+                                      ARISR_UINT32 offsets[], ARISR_UINT32 max_fragments, ARISR_UINT32 *count, const ARISR_AES128_KEY key);
+
+/* ===== HEADER FILTER ===== */
+
+/**
+ * @brief Called by the filtered parsers once the header CRC matches, before the data section.
+ *
+ * 'header' holds every decoded header field (ctrl, addresses, ctrl2, crc_header), 'data' is
+ * still NULL and ctrl2.data_length is the encrypted length. Returning anything but kARISR_OK
+ * drops the frame: the parser releases what it allocated and returns that code, without
+ * checking the data CRC or decrypting. 'user' is handed back untouched.
+ */
+typedef ARISR_ERR (*ARISR_HEADER_FILTER)(void *user, const ARISR_CHUNK *header);
+
+/**
+ * @brief Same as ARISR_proto_parse_len_ctx, with a filter on the header.
+ *
+ * @param buffer [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @param filter [in]  Header check, NULL to accept every frame.
+ * @param user   [in]  Handed back untouched to 'filter'.
+ * @return kARISR_OK on success, the error returned by 'filter', or the same error codes as ARISR_proto_parse_len.
+ *
+ * @note The caller is responsible for freeing the memory allocated for *buffer. With ARISR_proto_chunk_clean.
+ */
+ARISR_ERR ARISR_proto_parse_len_filtered_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id,
+                                             ARISR_HEADER_FILTER filter, void *user);
+
+/**
+ * @brief Same as ARISR_proto_parse_len_filtered_ctx, expanding 'key' first.
+ */
+ARISR_ERR ARISR_proto_parse_len_filtered(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id,
+                                         ARISR_HEADER_FILTER filter, void *user);
+
+/* ===== RELAY ===== */
+
+/**
+ * @brief Rewrites a received frame for forwarding, without decrypting it.
+ *
+ * CTRL1 gets the 'from' flag and 'relay' is written as destination C, inserted
+ * after the B destinations or replacing the previous relay. Only the header CRC
+ * is recomputed: ARIS, CTRL2, the ciphertext and its CRC are copied untouched,
+ * so no key is needed.
+ *
+ * @param buffer      [out] Forwarded frame, 'data' itself (rewritten in place) or not overlapping it.
+ * @param capacity    [in]  Size of 'buffer', 'data_length' + ARISR_ADDRESS_SIZE is always enough.
+ * @param length      [out] Size of the forwarded frame (also set when the buffer is too small).
+ * @param data        [in]  Received frame.
+ * @param data_length [in]  Number of bytes in 'data'.
+ * @param id          [in]  The expected Network ID section, checked at both ends of the frame.
+ * @param relay       [in]  6-byte address of this relay, the new destination C.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'capacity' is smaller than the frame,
+ *         kARISR_ERR_INVALID_ARGUMENT if 'buffer' partly overlaps 'data',
+ *         kARISR_ERR_INVALID_LENGTH, kARISR_ERR_NOT_SAME_ID, kARISR_ERR_NOT_SAME_END or
+ *         kARISR_ERR_NOT_SAME_CRC_HEADER for a frame that must not be forwarded,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ *
+ * @note The data CRC is not checked, the final receiver does it when decrypting.
+ */
+ARISR_ERR ARISR_proto_relay_rewrite(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length,
+                                    const ARISR_UINT8 *data, ARISR_UINT32 data_length, const ARISR_UINT8 *id, const ARISR_UINT8 *relay);
+
+/* ===== SCATTER-GATHER BUILD ===== */
+
+/**
+ * @brief Builds a frame as a list of pieces for writev / sendmsg, without a contiguous copy.
+ *
+ * The pieces are, in order: 'scratch->head', the caller's destinationsB array, 'scratch->middle',
+ * the ciphertext in 'cipher' and 'scratch->tail'. Absent sections are left out, so 'count'
+ * is 3 to ARISR_PROTO_IOV_MAX. The payload is encrypted once into 'cipher' together with its
+ * CRC, and the header CRC is taken over the pieces where they lie.
+ *
+ * @param iov             [out] Pieces of the frame, valid while 'scratch', 'cipher' and data->destinationsB are.
+ * @param count           [out] Number of pieces used in 'iov'.
+ * @param length          [out] Size of the whole frame (sum of the pieces).
+ * @param scratch         [out] Room for the fixed sections of the frame.
+ * @param cipher          [out] Ciphertext buffer, may be data->data itself if it has room for the padding.
+ *                              Unused (may be NULL) for a frame without data.
+ * @param cipher_capacity [in]  Size of 'cipher', data length + ARISR_AES128_BLOCK_SIZE is always enough.
+ * @param data            [in]  Chunk to encode.
+ * @param ctx             [in]  Key context from ARISR_aes_key_ctx_init.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'cipher' is too small,
+ *         kARISR_ERR_INVALID_ARGUMENT for missing sections, or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_proto_build_iov_ctx(ARISR_IOVEC iov[ARISR_PROTO_IOV_MAX], ARISR_UINT32 *count, ARISR_UINT32 *length, ARISR_FRAME_SCRATCH *scratch,
+                                    ARISR_UINT8 *cipher, ARISR_UINT32 cipher_capacity, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx);
+
+/**
+ * @brief Same as ARISR_proto_build_iov_ctx, expanding 'key' first.
+ */
+ARISR_ERR ARISR_proto_build_iov(ARISR_IOVEC iov[ARISR_PROTO_IOV_MAX], ARISR_UINT32 *count, ARISR_UINT32 *length, ARISR_FRAME_SCRATCH *scratch,
+                                ARISR_UINT8 *cipher, ARISR_UINT32 cipher_capacity, const ARISR_CHUNK *data, const ARISR_AES128_KEY key);
+
 /**
  * @brief Those functions are used step by step to pack, send, receive and unpack the data.
  * 
@@ -150,6 +675,21 @@ ARISR_ERR ARISR_proto_build(ARISR_UINT8 **buffer, ARISR_UINT32 *length, ARISR_CH
  */
 ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
 
+/**
+ * @brief Length-bounded version of ARISR_proto_recv.
+ *
+ * @param buffer Pointer to the ARISR_CHUNK_RAW structure where parsed data will be stored.
+ * @param data   Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length Number of bytes available in 'data'.
+ * @param key    The AES-128 key used to decrypt the 'aris' section.
+ * @param id     The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_LENGTH if 'length' does not match the frame,
+ *         or the same error codes as ARISR_proto_recv.
+ *
+ * @note If kARISR_ERR_INVALID_LENGTH is returned, the buffer is not allocated.
+ */
+ARISR_ERR ARISR_proto_recv_len(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id);
+
 /**
  * @brief Unpack and decrypt ARISR_CHUNK_RAW into an ARISR_CHUNK structure.
  *
@@ -202,6 +742,30 @@ ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARI
  */
 ARISR_ERR ARISR_proto_send(ARISR_UINT8 **buffer, ARISR_CHUNK_RAW *data, ARISR_UINT32 *length);
 
+/**
+ * @brief Same as ARISR_proto_recv, allocating through 'allocator'.
+ * @note Release the buffer with ARISR_proto_raw_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_recv_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Same as ARISR_proto_recv_len, allocating through 'allocator'.
+ * @note Release the buffer with ARISR_proto_raw_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_recv_len_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Same as ARISR_proto_unpack, allocating through 'allocator'.
+ * @note Release the buffer with ARISR_proto_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_unpack_alloc(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const ARISR_AES128_KEY key, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Same as ARISR_proto_pack, allocating through 'allocator'.
+ * @note Release the buffer with ARISR_proto_raw_chunk_clean_alloc and the same allocator.
+ */
+ARISR_ERR ARISR_proto_pack_alloc(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARISR_AES128_KEY key, const ARISR_ALLOCATOR *allocator);
+
 #endif // ARISR_PROTO_PARTIAL_FUNCTIONS
 
 #endif
@@ -0,0 +1,148 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_addr.h
+ * @brief This file contains the 48-bit address set used to filter frames by destination.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_ADDR_H
+#define LIB_ARISR_ADDR_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+#include "lib_arisr_comm.h"
+#include "lib_arisr_alloc.h"
+
+// Addresses per bucket, a bucket fills one 64-byte cache line
+#define ARISR_ADDR_SET_SLOTS        8
+#define ARISR_ADDR_SET_ALIGNMENT    64
+
+// Empty slot, out of the 48-bit range
+#define ARISR_ADDR_SET_EMPTY        0xFFFFFFFFFFFFFFFFULL
+
+/**
+ * @brief Bucket of an ARISR_ADDR_SET, one cache line.
+ */
+typedef struct {
+    ARISR_UINT64 slot[ARISR_ADDR_SET_SLOTS];
+} ARISR_ADDR_BUCKET;
+
+/**
+ * @brief Open-addressing set of ARISR_UINT48 addresses.
+ *
+ * Addresses are kept as 64-bit words in buckets of one cache line. A lookup
+ * hashes the address with a single multiply, compares the 8 words of its
+ * bucket and only moves on to the next bucket when that one is full, which
+ * the load factor (at most half) makes rare. There is no removal: clear and
+ * insert again when the set changes.
+ *
+ * Once filled the set is only read, so any number of threads can look it up.
+ */
+typedef struct {
+    ARISR_ADDR_BUCKET *buckets;
+    ARISR_UINT32 bucket_mask;                       // Number of buckets - 1 (power of two)
+    ARISR_UINT8 bucket_shift;                       // 64 - log2(number of buckets), keeps the top bits of the hash
+    ARISR_UINT32 capacity;                          // Addresses accepted by ARISR_addr_set_insert
+    ARISR_UINT32 count;                             // Addresses in the set
+
+    ARISR_ALLOCATOR allocator;                      // Owner of 'memory'
+    void *memory;
+} ARISR_ADDR_SET;
+
+/**
+ * @brief Allocates an empty address set.
+ *
+ * @param set       [out] Set to initialize.
+ * @param capacity  [in]  Largest number of addresses (1 to 2^28, less where size_t is 32 bits).
+ * @param allocator [in]  Allocator for the buckets, NULL for malloc.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if the allocation fails.
+ *
+ * @note Release it with ARISR_addr_set_destroy.
+ */
+ARISR_ERR ARISR_addr_set_create(ARISR_ADDR_SET *set, ARISR_UINT32 capacity, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Releases the buckets of a set and zeroes it.
+ *
+ * @param set [in] Set to destroy.
+ */
+void ARISR_addr_set_destroy(ARISR_ADDR_SET *set);
+
+/**
+ * @brief Removes every address.
+ *
+ * @param set [in] Set from ARISR_addr_set_create.
+ */
+void ARISR_addr_set_clear(ARISR_ADDR_SET *set);
+
+/**
+ * @brief Adds an address, nothing happens if it is already in.
+ *
+ * @param set     [in] Set from ARISR_addr_set_create.
+ * @param address [in] 6-byte address.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if the set holds 'capacity' addresses,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_addr_set_insert(ARISR_ADDR_SET *set, const ARISR_UINT8 *address);
+
+/**
+ * @brief Tells whether an address is in the set.
+ *
+ * @param set     [in] Set from ARISR_addr_set_create.
+ * @param address [in] 6-byte address.
+ * @return 1 if it is in, 0 otherwise.
+ */
+ARISR_UINT8 ARISR_addr_set_contains(const ARISR_ADDR_SET *set, const ARISR_UINT8 *address);
+
+/**
+ * @brief Checks the destinations of a raw frame (A, every B, and C for relayed frames).
+ *
+ * Only CTRL1 and the address sections are read: nothing is decrypted and no CRC is
+ * computed, so it can run on every frame off the air before ARISR_proto_parse_len.
+ *
+ * @param set    [in] Set from ARISR_addr_set_create.
+ * @param data   [in] Raw frame.
+ * @param length [in] Number of bytes available in 'data'.
+ * @return kARISR_OK if one destination is in the set, kARISR_ERR_NOT_ADDRESSED if none is,
+ *         kARISR_ERR_INVALID_LENGTH if 'length' does not cover the header,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_addr_set_match_raw(const ARISR_ADDR_SET *set, const ARISR_UINT8 *data, ARISR_UINT32 length);
+
+/**
+ * @brief ARISR_HEADER_FILTER keeping the frames with one destination in the set.
+ *
+ * Give it to ARISR_proto_parse_len_filtered_ctx with the set as 'user': the frames
+ * addressed elsewhere return kARISR_ERR_NOT_ADDRESSED before their data is decrypted.
+ *
+ * @param user   [in] The ARISR_ADDR_SET.
+ * @param header [in] Header decoded by the parser.
+ * @return kARISR_OK if one destination is in the set, kARISR_ERR_NOT_ADDRESSED otherwise.
+ */
+ARISR_ERR ARISR_addr_set_filter(void *user, const ARISR_CHUNK *header);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
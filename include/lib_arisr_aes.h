@@ -23,6 +23,31 @@
   #define CTR 1
 #endif
 
+// AES_TTABLE selects the 32-bit table driven ECB backend: one 1KB table per direction
+// (rotated at run time) and 32-bit round keys, including the decryption schedule of
+// the equivalent inverse cipher. It is enabled by default on 64-bit/x86 hosts and kept
+// off on microcontrollers, where the byte oriented cipher is smaller.
+// NB: it changes the size of struct AES_ctx, so the library and the code including
+//     this header must be built with the same value.
+#ifndef AES_TTABLE
+  #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) || defined(__aarch64__)
+    #define AES_TTABLE 1
+  #else
+    #define AES_TTABLE 0
+  #endif
+#endif
+
+// AES_NI adds an AES-NI implementation of the ECB functions, used only when cpuid
+// reports the instructions at run time; otherwise the portable cipher above is used.
+// Built with GCC/Clang target attributes, so no -maes flag is needed.
+#ifndef AES_NI
+  #if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define AES_NI 1
+  #else
+    #define AES_NI 0
+  #endif
+#endif
+
 
 #define AES128 1
 //#define AES192 1
@@ -44,6 +69,13 @@
 struct AES_ctx
 {
   uint8_t RoundKey[AES_keyExpSize];
+#if defined(AES_TTABLE) && (AES_TTABLE == 1)
+  uint32_t rk[AES_keyExpSize / 4];   // Encryption round keys, big-endian columns
+  uint32_t drk[AES_keyExpSize / 4];  // Decryption round keys (reversed, InvMixColumns applied)
+#endif
+#if defined(AES_NI) && (AES_NI == 1)
+  uint8_t InvRoundKey[AES_keyExpSize]; // Decryption round keys for AESDEC (reversed, AESIMC applied)
+#endif
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
   uint8_t Iv[AES_BLOCKLEN];
 #endif
@@ -62,6 +94,11 @@ void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv);
 void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf);
 void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf);
 
+// Same as above over 'length' bytes (multiple of AES_BLOCKLEN). The blocks are
+// independent, so the AES-NI path keeps 8 of them in flight per iteration.
+void AES_ECB_encrypt_blocks(const struct AES_ctx* ctx, uint8_t* buf, size_t length);
+void AES_ECB_decrypt_blocks(const struct AES_ctx* ctx, uint8_t* buf, size_t length);
+
 #endif // #if defined(ECB) && (ECB == !)
 
 
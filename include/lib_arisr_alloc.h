@@ -0,0 +1,136 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_alloc.h
+ * @brief This file contains the pluggable allocator and the bump-pointer arena of the ARISr library.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_ALLOC_H
+#define LIB_ARISR_ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+
+// Alignment of every block returned by an arena (power of two)
+#ifndef ARISR_ARENA_ALIGNMENT
+#define ARISR_ARENA_ALIGNMENT       16
+#endif
+
+#define ARISR_ARENA_ALIGN(size)     (((size) + (ARISR_ARENA_ALIGNMENT - 1)) & ~(ARISR_ARENA_ALIGNMENT - 1))
+
+// Worst-case arena bytes taken by one decoded chunk (destinationsB, destinationC, ctrl2 and data)
+#define ARISR_ARENA_CHUNK_SIZE      (ARISR_ARENA_ALIGN(ARISR_PROTO_MAX_DESTINATIONS * ARISR_ADDRESS_SIZE) \
+                                   + ARISR_ARENA_ALIGN(ARISR_ADDRESS_SIZE) \
+                                   + ARISR_ARENA_ALIGN(ARISR_CTRL2_SECTION_SIZE) \
+                                   + ARISR_ARENA_ALIGN(ARISR_PROTO_MAX_DATA_LENGTH))
+
+/**
+ * @brief Memory interface used for the variable-size fields of ARISR_CHUNK and ARISR_CHUNK_RAW.
+ *
+ * 'alloc' returns NULL on failure. 'free' may be a no-op (arenas release everything at once).
+ * 'user' is handed back untouched to both callbacks.
+ */
+typedef struct {
+    void *(*alloc)(void *user, size_t size);
+    void  (*free)(void *user, void *ptr);
+    void  *user;
+} ARISR_ALLOCATOR;
+
+/**
+ * @brief Bump-pointer arena.
+ *
+ * Allocation advances 'used', individual frees are ignored and ARISR_arena_reset
+ * releases every block at once. An arena is not thread-safe: give each thread its own.
+ */
+typedef struct {
+    ARISR_UINT8 *memory;            // Backing storage
+    ARISR_UINT32 capacity;          // Size of 'memory'
+    ARISR_UINT32 used;              // Bytes handed out (including alignment)
+    ARISR_UINT8 owned;              // 'memory' was allocated by ARISR_arena_create
+} ARISR_ARENA;
+
+// malloc / free
+extern const ARISR_ALLOCATOR ARISR_DEFAULT_ALLOCATOR;
+
+#define ARISR_ALLOC(allocator, size)    ((allocator)->alloc((allocator)->user, (size)))
+#define ARISR_FREE(allocator, ptr)      ((allocator)->free((allocator)->user, (ptr)))
+
+/**
+ * @brief Initializes an arena over caller-supplied memory (static buffer, stack, ...).
+ *
+ * @param arena    [out] Arena to initialize.
+ * @param memory   [in]  Backing storage, must outlive the arena.
+ * @param capacity [in]  Size of 'memory' in bytes.
+ * @return kARISR_OK on success, or kARISR_ERR_INVALID_ARGUMENT for NULL parameters.
+ */
+ARISR_ERR ARISR_arena_init(ARISR_ARENA *arena, void *memory, ARISR_UINT32 capacity);
+
+/**
+ * @brief Initializes an arena with 'capacity' bytes taken from the heap.
+ *
+ * @param arena    [out] Arena to initialize.
+ * @param capacity [in]  Size of the arena in bytes (see ARISR_ARENA_CHUNK_SIZE).
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if the allocation fails.
+ *
+ * @note Release it with ARISR_arena_destroy.
+ */
+ARISR_ERR ARISR_arena_create(ARISR_ARENA *arena, ARISR_UINT32 capacity);
+
+/**
+ * @brief Releases the memory of an arena made by ARISR_arena_create and zeroes it.
+ *
+ * @param arena [in] Arena to destroy.
+ */
+void ARISR_arena_destroy(ARISR_ARENA *arena);
+
+/**
+ * @brief Takes 'size' bytes from the arena, aligned to ARISR_ARENA_ALIGNMENT.
+ *
+ * @param arena [in] Arena to allocate from.
+ * @param size  [in] Number of bytes.
+ * @return Pointer to the block, or NULL if the arena is exhausted.
+ */
+void *ARISR_arena_alloc(ARISR_ARENA *arena, size_t size);
+
+/**
+ * @brief Releases every block of the arena at once. The memory itself is kept.
+ *
+ * @param arena [in] Arena to reset.
+ */
+void ARISR_arena_reset(ARISR_ARENA *arena);
+
+/**
+ * @brief Builds an ARISR_ALLOCATOR that takes its memory from 'arena'.
+ *
+ * @param allocator [out] Allocator to fill, valid as long as 'arena' is.
+ * @param arena     [in]  Arena backing the allocator.
+ * @return kARISR_OK on success, or kARISR_ERR_INVALID_ARGUMENT for NULL parameters.
+ */
+ARISR_ERR ARISR_arena_allocator(ARISR_ALLOCATOR *allocator, ARISR_ARENA *arena);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
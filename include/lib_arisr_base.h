@@ -77,6 +77,8 @@ typedef unsigned short	ARISR_UINT16;
 typedef short			      ARISR_SINT16;
 typedef unsigned int	  ARISR_UINT32;
 typedef int				      ARISR_SINT32;
+typedef unsigned __int64 ARISR_UINT64;
+typedef __int64         ARISR_SINT64;
 #elif defined(ARISR_ENV_UNIX) && !ARISR_FORCE_USE_STDINT
 typedef unsigned char   ARISR_UINT8;
 typedef char            ARISR_SINT8;
@@ -84,6 +86,8 @@ typedef unsigned int	  ARISR_UINT16;
 typedef int 			      ARISR_SINT16;
 typedef unsigned long 	ARISR_UINT32;
 typedef long			      ARISR_SINT32;
+typedef unsigned long long ARISR_UINT64;
+typedef long long       ARISR_SINT64;
 #else
 typedef uint8_t         ARISR_UINT8;
 typedef int8_t          ARISR_SINT8;
@@ -91,6 +95,8 @@ typedef uint16_t    	  ARISR_UINT16;
 typedef int16_t 		    ARISR_SINT16;
 typedef uint32_t    	  ARISR_UINT32;
 typedef int32_t			    ARISR_SINT32;
+typedef uint64_t        ARISR_UINT64;
+typedef int64_t         ARISR_SINT64;
 #endif
 
 // NB not used by all library code!
@@ -116,6 +122,7 @@ typedef ARISR_UINT32 ARISR_UCHAR; // unicode character
 #define ARISR_MAX_UINT16		    0xffff
 #define ARISR_MAX_UINT24		    0xffffffL
 #define ARISR_MAX_UINT32		    0xffffffffL
+#define ARISR_MAX_UINT64		    0xffffffffffffffffULL
 
 
 /******************************************************************************/
@@ -0,0 +1,110 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_batch.h
+ * @brief This file contains the batch (structure-of-arrays) parser of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_BATCH_H
+#define LIB_ARISR_BATCH_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_comm.h"
+#include "lib_arisr_crypt.h"
+#include "lib_arisr_alloc.h"
+
+/**
+ * @brief Columnar output of ARISR_proto_parse_batch.
+ *
+ * Column entry 'i' belongs to frame 'i' of the batch. Only the entries with
+ * status[i] == kARISR_OK are meaningful. The plaintext of frame 'i' is
+ * payload[payload_offset[i] .. payload_offset[i] + payload_length[i]).
+ */
+typedef struct {
+    ARISR_UINT32 capacity;              // Frames every column can hold
+    ARISR_UINT32 count;                 // Frames in the last batch
+    ARISR_UINT32 valid;                 // Frames of the last batch with status kARISR_OK
+
+    ARISR_ERR *status;                  // Per-frame result
+    ARISR_UINT32 *payload_offset;       // Offset of the plaintext in 'payload'
+    ARISR_UINT32 *payload_length;       // Length of the plaintext
+    ARISR_UINT48 *origin;
+    ARISR_UINT48 *destinationA;
+    ARISR_UINT8 *destinations;          // Number of destinationsB
+    ARISR_UINT8 *sequence;
+    ARISR_UINT8 *identifier;
+
+    ARISR_UINT8 *payload;               // Decrypted data of every frame, back to back
+    ARISR_UINT32 payload_capacity;
+    ARISR_UINT32 payload_used;
+
+    ARISR_ALLOCATOR allocator;          // Owner of the columns
+    void *memory;
+} ARISR_BATCH;
+
+/**
+ * @brief Allocates the columns of a batch in a single block.
+ *
+ * @param batch            [out] Batch to initialize.
+ * @param capacity         [in]  Maximum number of frames per call.
+ * @param payload_capacity [in]  Bytes for the decrypted data of a whole batch
+ *                               (capacity * ARISR_PROTO_MAX_DATA_LENGTH is always enough).
+ * @param allocator        [in]  Allocator for the block, NULL for malloc.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if the allocation fails.
+ *
+ * @note Release it with ARISR_batch_destroy.
+ */
+ARISR_ERR ARISR_batch_create(ARISR_BATCH *batch, ARISR_UINT32 capacity, ARISR_UINT32 payload_capacity, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Releases the columns of a batch and zeroes it.
+ *
+ * @param batch [in] Batch to destroy.
+ */
+void ARISR_batch_destroy(ARISR_BATCH *batch);
+
+/**
+ * @brief Parses 'count' frames into the columns of 'batch'.
+ *
+ * The first pass validates every header, CRC and end mark through the zero-copy view
+ * and fills the header columns, the second pass decrypts every payload back to back
+ * into batch->payload. Nothing is allocated.
+ *
+ * @param frames  [in]  Frames to parse.
+ * @param lengths [in]  Number of bytes available in each frame.
+ * @param count   [in]  Number of frames, at most batch->capacity.
+ * @param ctx     [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id      [in]  The expected Network ID section to match the incoming data.
+ * @param batch   [out] Columns to fill, previous content is discarded.
+ * @return kARISR_OK when the batch was processed (see batch->status for each frame),
+ *         kARISR_ERR_INVALID_ARGUMENT if 'count' exceeds the capacity or kARISR_ERR_GENERIC for NULL parameters.
+ *         A frame whose payload does not fit in batch->payload gets kARISR_ERR_BUFFER_OVERFLOW.
+ */
+ARISR_ERR ARISR_proto_parse_batch(const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                                  const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, ARISR_BATCH *batch);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
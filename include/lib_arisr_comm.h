@@ -86,6 +86,94 @@ typedef struct {
     ARISR_UINT8 freq_switch;
 } ARISR_CHUNK_CTRL2;
 
+/* ===== CTRL FIELD TABLES ===== */
+// One entry per field of the ARISR_CHUNK_CTRL/CTRL2 structs: (member, mask, shift).
+// The decoders and encoders below are generated from these lists, so the word is
+// loaded or stored once for the whole section instead of once per field.
+#define ARISR_CTRL_FIELDS(FIELD)                                                    \
+    FIELD(version,      ARISR_CTRL_VERSION_MASK,        ARISR_CTRL_VERSION_SHIFT)   \
+    FIELD(destinations, ARISR_CTRL_DESTS_MASK,          ARISR_CTRL_DESTS_SHIFT)     \
+    FIELD(option,       ARISR_CTRL_OPTION_MASK,         ARISR_CTRL_OPTION_SHIFT)    \
+    FIELD(from,         ARISR_CTRL_FROM_MASK,           ARISR_CTRL_FROM_SHIFT)      \
+    FIELD(sequence,     ARISR_CTRL_SEQUENCE_MASK,       ARISR_CTRL_SEQUENCE_SHIFT)  \
+    FIELD(retry,        ARISR_CTRL_RETRY_MASK,          ARISR_CTRL_RETRY_SHIFT)     \
+    FIELD(more_data,    ARISR_CTRL_MD_MASK,             ARISR_CTRL_MD_SHIFT)        \
+    FIELD(identifier,   ARISR_CTRL_ID_MASK,             ARISR_CTRL_ID_SHIFT)        \
+    FIELD(more_header,  ARISR_CTRL_MH_MASK,             ARISR_CTRL_MH_SHIFT)
+
+// 'data_length' is not listed, it is stored as n * ARISR_DATA_MULT Bytes
+#define ARISR_CTRL2_FIELDS(FIELD)                                                       \
+    FIELD(feature,      ARISR_CTRL2_FEATURE_MASK,       ARISR_CTRL2_FEATURE_SHIFT)      \
+    FIELD(neg_answer,   ARISR_CTRL2_NEG_ANSWER_MASK,    ARISR_CTRL2_NEG_ANSWER_SHIFT)   \
+    FIELD(freq_switch,  ARISR_CTRL2_FREQ_SWITCH_MASK,   ARISR_CTRL2_FREQ_SWITCH_SHIFT)
+
+#define ARISR_CTRL_DECODE_FIELD(member, mask, shift)    out->member = (ARISR_UINT8)((word & (mask)) >> (shift));
+#define ARISR_CTRL_ENCODE_FIELD(member, mask, shift)    word |= ((ARISR_UINT32)in->member << (shift)) & (mask);
+
+/**
+ * @brief Load a 4 bytes control section as a big-endian word
+ * @param raw 4 bytes of CTRL1 or CTRL2
+ * @return ARISR_UINT32 word
+ */
+static inline ARISR_UINT32 ARISR_proto_ctrl_load(const ARISR_UINT8 *raw) {
+    return ((ARISR_UINT32)raw[0] << 24) | ((ARISR_UINT32)raw[1] << 16) | ((ARISR_UINT32)raw[2] << 8) | (ARISR_UINT32)raw[3];
+}
+
+/**
+ * @brief Store a word as a 4 bytes big-endian control section
+ * @param raw  4 bytes of CTRL1 or CTRL2
+ * @param word Value to store
+ */
+static inline void ARISR_proto_ctrl_store(ARISR_UINT8 *raw, ARISR_UINT32 word) {
+    raw[0] = (ARISR_UINT8)(word >> 24);
+    raw[1] = (ARISR_UINT8)(word >> 16);
+    raw[2] = (ARISR_UINT8)(word >>  8);
+    raw[3] = (ARISR_UINT8)(word);
+}
+
+/**
+ * @brief Decode the whole CTRL1 section in one pass
+ * @param raw 4 bytes of CTRL1
+ * @param out Decoded fields
+ */
+static inline void ARISR_proto_ctrl_decode(const ARISR_UINT8 *raw, ARISR_CHUNK_CTRL *out) {
+    const ARISR_UINT32 word = ARISR_proto_ctrl_load(raw);
+    ARISR_CTRL_FIELDS(ARISR_CTRL_DECODE_FIELD)
+}
+
+/**
+ * @brief Encode the whole CTRL1 section in one pass, each field masked to its width
+ * @param raw 4 bytes of CTRL1
+ * @param in  Fields to encode
+ */
+static inline void ARISR_proto_ctrl_encode(ARISR_UINT8 *raw, const ARISR_CHUNK_CTRL *in) {
+    ARISR_UINT32 word = 0;
+    ARISR_CTRL_FIELDS(ARISR_CTRL_ENCODE_FIELD)
+    ARISR_proto_ctrl_store(raw, word);
+}
+
+/**
+ * @brief Decode the whole CTRL2 section in one pass
+ * @param raw 4 bytes of CTRL2
+ * @param out Decoded fields, 'data_length' in Bytes
+ */
+static inline void ARISR_proto_ctrl2_decode(const ARISR_UINT8 *raw, ARISR_CHUNK_CTRL2 *out) {
+    const ARISR_UINT32 word = ARISR_proto_ctrl_load(raw);
+    out->data_length = ((word & ARISR_CTRL2_DATA_LENGTH_MASK) >> ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT;
+    ARISR_CTRL2_FIELDS(ARISR_CTRL_DECODE_FIELD)
+}
+
+/**
+ * @brief Encode the whole CTRL2 section in one pass, each field masked to its width
+ * @param raw 4 bytes of CTRL2
+ * @param in  Fields to encode, 'data_length' in Bytes (multiple of ARISR_DATA_MULT)
+ */
+static inline void ARISR_proto_ctrl2_encode(ARISR_UINT8 *raw, const ARISR_CHUNK_CTRL2 *in) {
+    ARISR_UINT32 word = ((in->data_length / ARISR_DATA_MULT) << ARISR_CTRL2_DATA_LENGTH_SHIFT) & ARISR_CTRL2_DATA_LENGTH_MASK;
+    ARISR_CTRL2_FIELDS(ARISR_CTRL_ENCODE_FIELD)
+    ARISR_proto_ctrl_store(raw, word);
+}
+
 typedef struct {
     ARISR_UINT8 id[4];                  // 4 Bytes
     ARISR_UINT8 aris[4];                // 4 Bytes
@@ -101,6 +189,75 @@ typedef struct {
     ARISR_UINT8 end[2];                 // 4 Bytes
 } ARISR_CHUNK;
 
+/* ===== FIXED-CAPACITY CHUNK ===== */
+// Capacity of ARISR_CHUNK_STATIC, the protocol maxima by default. Lower them to shrink
+// the struct on small targets, frames beyond them are rejected with kARISR_ERR_BUFFER_OVERFLOW.
+#ifndef ARISR_STATIC_MAX_DESTINATIONS
+#define ARISR_STATIC_MAX_DESTINATIONS   ARISR_PROTO_MAX_DESTINATIONS
+#endif
+
+#ifndef ARISR_STATIC_MAX_DATA_LENGTH
+#define ARISR_STATIC_MAX_DATA_LENGTH    ARISR_PROTO_MAX_DATA_LENGTH
+#endif
+
+/**
+ * @brief Same content as ARISR_CHUNK with every field inline, nothing is allocated.
+ */
+typedef struct {
+    ARISR_UINT8 id[4];                                          // 4 Bytes
+    ARISR_UINT8 aris[4];                                        // 4 Bytes
+    ARISR_CHUNK_CTRL ctrl;                                      // 4 Bytes
+    ARISR_UINT48 origin;                                        // 6 Bytes
+    ARISR_UINT48 destinationA;                                  // 6 Bytes
+    ARISR_UINT48 destinationsB[ARISR_STATIC_MAX_DESTINATIONS];  // ... n*6 Bytes
+    ARISR_UINT48 destinationC;                                  // 6 Bytes
+    ARISR_CHUNK_CTRL2 ctrl2;                                    // 4 Bytes
+    ARISR_UINT8 crc_header[2];                                  // 2 Bytes
+    ARISR_UINT8 data[ARISR_STATIC_MAX_DATA_LENGTH];             // n Bytes
+    ARISR_UINT8 crc_data[2];                                    // 2 Bytes
+    ARISR_UINT8 end[4];                                         // 4 Bytes
+} ARISR_CHUNK_STATIC;
+
+/**
+ * @brief Zero-copy view over a raw frame.
+ *
+ * Every pointer references the caller's receive buffer, so the view is only
+ * valid while that buffer is alive and unmodified. Nothing is allocated.
+ */
+typedef struct {
+    const ARISR_UINT8 *frame;                                   // Start of the frame
+    ARISR_UINT32 length;                                        // Total frame length
+    ARISR_CHUNK_CTRL ctrl;                                      // Decoded CTRL1
+    ARISR_CHUNK_CTRL2 ctrl2;                                    // Decoded CTRL2 (data_length = encrypted length)
+    const ARISR_UINT8 *origin;                                  // 6 Bytes
+    const ARISR_UINT8 *destinationA;                            // 6 Bytes
+    const ARISR_UINT8 (*destinationsB)[ARISR_ADDRESS_SIZE];     // n*6 Bytes, NULL if none
+    const ARISR_UINT8 *destinationC;                            // 6 Bytes,   NULL if not from relay
+    ARISR_UINT32 header_length;                                 // Bytes covered by the header CRC
+    ARISR_UINT32 data_offset;                                   // Offset of the encrypted data
+} ARISR_FRAME_VIEW;
+
+/**
+ * @brief Points to a piece of a message or a frame (reassembly, scatter-gather build).
+ */
+typedef struct {
+    const ARISR_UINT8 *base;
+    ARISR_UINT32 length;
+} ARISR_IOVEC;
+
+/* ===== SCATTER-GATHER FRAME ===== */
+// Pieces of a frame built by ARISR_proto_build_iov: head, destinations B, middle, ciphertext, tail
+#define ARISR_PROTO_IOV_MAX             5
+
+/**
+ * @brief Fixed sections of a frame built by ARISR_proto_build_iov, the pieces not owned by the caller.
+ */
+typedef struct {
+    ARISR_UINT8 head[ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2];    // ID, ARIS, CTRL1, ORIGIN, DEST A
+    ARISR_UINT8 middle[ARISR_ADDRESS_SIZE + ARISR_CTRL2_SECTION_SIZE + ARISR_CRC_SIZE];            // DEST C, CTRL2, CRC header
+    ARISR_UINT8 tail[ARISR_CRC_SIZE + ARISR_PROTO_ID_SIZE];                                        // CRC data, END
+} ARISR_FRAME_SCRATCH;
+
 
 
 #endif
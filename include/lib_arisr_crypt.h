@@ -30,12 +30,44 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "lib_arisr_base.h"
+#include "lib_arisr_aes.h"
 
 // Polinomio standard CRC-16-CCITT (X^16 + X^12 + X^5 + 1) = 0x1021
 // CRC-16-CCITT-FALSE or CRC-16/IBM-CCITT or CRC-16/AUTOSAR or CRC-16/IBM-3740
 #define CRC16_POLYNOMIAL 0x1021
 #define CRC16_INITIAL_VALUE 0xFFFF  // Initial value for CRC16 calculation
 
+// Bytes processed per step by ARISR_crypt_crc16_calculate: 1 (crc16_table only),
+// 4 (+1.5KB of tables) or 8 (+3.5KB). Hosts use 8, small targets 4.
+#ifndef ARISR_CRC16_SLICES
+  #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) || defined(__aarch64__)
+    #define ARISR_CRC16_SLICES 8
+  #else
+    #define ARISR_CRC16_SLICES 4
+  #endif
+#endif
+
+// Carry-less multiply (PCLMULQDQ) folding for long buffers on x86, used only when
+// cpuid reports the instruction. The result is identical to the table version.
+#ifndef ARISR_CRC16_CLMUL
+  #if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define ARISR_CRC16_CLMUL 1
+  #else
+    #define ARISR_CRC16_CLMUL 0
+  #endif
+#endif
+
+// Bytes encrypted (or decrypted) before the data CRC catches up in the fused kernels. Hosts
+// take 256 so the pipelined AES and the folding CRC still see long runs while the strip is
+// in L1, small targets without data cache fuse every 16-byte block. Multiple of 16.
+#ifndef ARISR_AES_CRC_STRIP
+  #if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) || defined(__aarch64__)
+    #define ARISR_AES_CRC_STRIP 256
+  #else
+    #define ARISR_AES_CRC_STRIP 16
+  #endif
+#endif
+
 static const ARISR_UINT16 crc16_table[256] = {
     0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
     0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6, 0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
@@ -77,6 +109,52 @@ static const ARISR_UINT16 crc16_table[256] = {
  */
 ARISR_UINT16 ARISR_crypt_crc16_calculate(const ARISR_UINT8 *data, const ARISR_UINT32 length);
 
+/**
+ * @brief Running CRC-16 over data given in several pieces (DMA buffers, scatter-gather lists).
+ *
+ * ARISR_crypt_crc16_init, any number of ARISR_crypt_crc16_update, then ARISR_crypt_crc16_final
+ * give the same value as ARISR_crypt_crc16_calculate over the concatenated pieces.
+ */
+typedef struct {
+    ARISR_UINT16 crc;
+} ARISR_CRC16_CTX;
+
+/**
+ * @brief Starts a CRC-16 with CRC16_INITIAL_VALUE.
+ *
+ * @param ctx [out] Running CRC.
+ */
+void ARISR_crypt_crc16_init(ARISR_CRC16_CTX *ctx);
+
+/**
+ * @brief Adds the next 'length' bytes to a running CRC-16.
+ *
+ * @param ctx    [in,out] Running CRC from ARISR_crypt_crc16_init.
+ * @param data   [in]     Next bytes, may be NULL when 'length' is 0.
+ * @param length [in]     Number of bytes in 'data'.
+ */
+void ARISR_crypt_crc16_update(ARISR_CRC16_CTX *ctx, const ARISR_UINT8 *data, ARISR_UINT32 length);
+
+/**
+ * @brief Returns the CRC-16 of every byte given to ARISR_crypt_crc16_update.
+ *
+ * @param ctx [in] Running CRC. It stays usable for more updates.
+ * @return The 16-bit CRC value.
+ */
+ARISR_UINT16 ARISR_crypt_crc16_final(const ARISR_CRC16_CTX *ctx);
+
+/**
+ * @brief Merges the CRC-16 of two consecutive segments computed separately.
+ *
+ * Costs O(log length_b) small multiplications, whatever the size of the segments.
+ *
+ * @param crc_a    [in] ARISR_crypt_crc16_calculate of the first segment.
+ * @param crc_b    [in] ARISR_crypt_crc16_calculate of the second segment.
+ * @param length_b [in] Number of bytes of the second segment.
+ * @return The CRC-16 of the first segment followed by the second one.
+ */
+ARISR_UINT16 ARISR_crypt_crc16_combine(ARISR_UINT16 crc_a, ARISR_UINT16 crc_b, ARISR_UINT32 length_b);
+
 
 
 // =================================================================================================
@@ -90,6 +168,23 @@ typedef
     ARISR_UINT8 ARISR_AES128_KEY[ARISR_AES128_BLOCK_SIZE];
 #pragma pack()
 
+/**
+ * @brief Expanded AES-128 key, built once and reused across frames.
+ *
+ * Holds the round keys used by both ECB directions and the byte added to the
+ * 'aris' section, so no key expansion is done per frame. Build it with
+ * ARISR_aes_key_ctx_init and rebuild it only when the network key changes.
+ *
+ * ARISR_aes_key_ctx_lazy only keeps the 'aris' byte and a pointer to the key:
+ * the round keys are expanded by the first payload encryption or decryption,
+ * so frames rejected on their header never pay for it.
+ */
+typedef struct {
+    struct AES_ctx aes;     // Expanded round keys
+    ARISR_UINT8 aris;       // Last byte of the key (0 for the null key)
+    const ARISR_UINT8 *key; // Key still to expand into 'aes', NULL once expanded
+} ARISR_KEY_CTX;
+
 
 /**
  * @brief Static function to check if the AES key is zero.
@@ -132,6 +227,53 @@ ARISR_ERR ARISR_aes_aris_decrypt(const ARISR_AES128_KEY key, const ARISR_UINT8 *
  */
 ARISR_ERR ARISR_aes_aris_encrypt(const ARISR_AES128_KEY key, ARISR_UINT8 *aris);
 
+/**
+ * @brief Expands an AES-128 key into an ARISR_KEY_CTX.
+ *
+ * @param ctx[out]  Key context to initialize
+ * @param key[in]   128-bit key, NULL selects the default null key
+ *
+ * @retval kARISR_OK           Context ready
+ * @retval kARISR_ERR_GENERIC  'ctx' is NULL
+ */
+ARISR_ERR ARISR_aes_key_ctx_init(ARISR_KEY_CTX *ctx, const ARISR_AES128_KEY key);
+
+/**
+ * @brief Prepares an ARISR_KEY_CTX whose round keys are only expanded when first needed.
+ *
+ * Meant for a single call with a raw key: the 'aris' checks are ready at once, and
+ * the first function that encrypts or decrypts a payload expands the key in 'ctx'.
+ *
+ * @param ctx[out]  Key context to initialize
+ * @param key[in]   128-bit key, NULL selects the default null key; it must outlive 'ctx'
+ *
+ * @retval kARISR_OK           Context ready
+ * @retval kARISR_ERR_GENERIC  'ctx' is NULL
+ *
+ * @note The context is written on its first use, so it must not be shared between
+ *       threads or declared const. Use ARISR_aes_key_ctx_init for shared contexts.
+ */
+ARISR_ERR ARISR_aes_key_ctx_lazy(ARISR_KEY_CTX *ctx, const ARISR_AES128_KEY key);
+
+/**
+ * @brief Same as ARISR_aes_aris_decrypt, using the byte stored in an ARISR_KEY_CTX.
+ *
+ * @param ctx   Initialized key context.
+ * @param aris  A 4-byte array to be checked.
+ * @return kARISR_OK if 'aris' becomes "ARIS" after the subtraction,
+ *         otherwise kARISR_ERR_NOT_SAME_ARIS.
+ */
+ARISR_ERR ARISR_aes_aris_decrypt_ctx(const ARISR_KEY_CTX *ctx, const ARISR_UINT8 *aris);
+
+/**
+ * @brief Same as ARISR_aes_aris_encrypt, using the byte stored in an ARISR_KEY_CTX.
+ *
+ * @param ctx   Initialized key context.
+ * @param aris  A 4-byte buffer to be modified in place.
+ * @return kARISR_OK on success, otherwise kARISR_ERR_GENERIC if inputs are null.
+ */
+ARISR_ERR ARISR_aes_aris_encrypt_ctx(const ARISR_KEY_CTX *ctx, ARISR_UINT8 *aris);
+
 /**
  * @brief AES-128 Encryption with PKCS#7 Padding
  * 
@@ -156,6 +298,64 @@ ARISR_ERR ARISR_aes_data_encrypt(const ARISR_AES128_KEY key,
                                  ARISR_UINT8 **output,
                                  ARISR_UINT32 *output_len);
 
+/**
+ * @brief Same as ARISR_aes_data_encrypt, with a pre-expanded key.
+ * 
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Plaintext data to encrypt
+ * @param input_len[in]   Length of plaintext data
+ * @param output[out]     Encrypted data buffer (caller must free)
+ * @param output_len[out] Length of encrypted data
+ * 
+ * @note The caller is responsible for freeing the memory allocated for *output.
+ */
+ARISR_ERR ARISR_aes_data_encrypt_ctx(const ARISR_KEY_CTX *ctx,
+                                     const ARISR_UINT8 *input,
+                                     ARISR_UINT32 input_len,
+                                     ARISR_UINT8 **output,
+                                     ARISR_UINT32 *output_len);
+
+/**
+ * @brief AES-128 Encryption with PKCS#7 Padding into a caller-supplied buffer
+ * 
+ * Same as ARISR_aes_data_encrypt, but the padded plaintext is encrypted directly in
+ * 'output' without any heap allocation. 'input' and 'output' may be the same buffer.
+ * 
+ * @param key[in]         128-bit encryption key
+ * @param input[in]       Plaintext data to encrypt
+ * @param input_len[in]   Length of plaintext data (1 <= len <= MAX_INPUT_LEN)
+ * @param output[out]     Encrypted data buffer
+ * @param output_cap[in]  Capacity of the encrypted data buffer
+ * @param output_len[out] Length of encrypted data
+ * 
+ * @retval kARISR_OK                  Encryption successful
+ * @retval kARISR_ERR_INVALID_ARG     Invalid input parameters
+ * @retval kARISR_ERR_BUFFER_OVERFLOW 'output_cap' is smaller than the padded length
+ */
+ARISR_ERR ARISR_aes_data_encrypt_into(const ARISR_AES128_KEY key,
+                                      const ARISR_UINT8 *input,
+                                      ARISR_UINT32 input_len,
+                                      ARISR_UINT8 *output,
+                                      ARISR_UINT32 output_cap,
+                                      ARISR_UINT32 *output_len);
+
+/**
+ * @brief Same as ARISR_aes_data_encrypt_into, with a pre-expanded key.
+ * 
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Plaintext data to encrypt
+ * @param input_len[in]   Length of plaintext data
+ * @param output[out]     Encrypted data buffer
+ * @param output_cap[in]  Capacity of the encrypted data buffer
+ * @param output_len[out] Length of encrypted data
+ */
+ARISR_ERR ARISR_aes_data_encrypt_into_ctx(const ARISR_KEY_CTX *ctx,
+                                          const ARISR_UINT8 *input,
+                                          ARISR_UINT32 input_len,
+                                          ARISR_UINT8 *output,
+                                          ARISR_UINT32 output_cap,
+                                          ARISR_UINT32 *output_len);
+
 /**
  * @brief AES-128 Decryption with PKCS#7 Padding Validation
  * 
@@ -180,6 +380,146 @@ ARISR_ERR ARISR_aes_data_decrypt(const ARISR_AES128_KEY key,
                                  ARISR_UINT32 input_len,
                                  ARISR_UINT8 **output,
                                  ARISR_UINT32 *output_len);
+
+/**
+ * @brief Same as ARISR_aes_data_decrypt, with a pre-expanded key.
+ * 
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Ciphertext data to decrypt
+ * @param input_len[in]   Length of ciphertext data (must be block-aligned)
+ * @param output[out]     Decrypted data buffer (caller must free)
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ * 
+ * @note The caller is responsible for freeing the memory allocated for *output.
+ */
+ARISR_ERR ARISR_aes_data_decrypt_ctx(const ARISR_KEY_CTX *ctx,
+                                     const ARISR_UINT8 *input,
+                                     ARISR_UINT32 input_len,
+                                     ARISR_UINT8 **output,
+                                     ARISR_UINT32 *output_len);
+
+/**
+ * @brief AES-128 Decryption with PKCS#7 Padding Validation, in place
+ * 
+ * The ciphertext is decrypted over itself (e.g. in the receive buffer) and no heap
+ * memory is used. On success the plaintext is the first 'output_len' bytes of 'data'.
+ * 
+ * @param key[in]         128-bit decryption key (same as encryption key)
+ * @param data[in,out]    Ciphertext, replaced by the decrypted data
+ * @param data_len[in]    Length of ciphertext data (must be block-aligned)
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ * 
+ * @retval kARISR_OK               Decryption successful
+ * @retval kARISR_ERR_INVALID_ARG  Invalid parameters
+ * @retval kARISR_ERR_BAD_PADDING  Invalid PKCS#7 padding
+ * 
+ * @note 'data' is decrypted even when the padding is rejected.
+ */
+ARISR_ERR ARISR_aes_data_decrypt_inplace(const ARISR_AES128_KEY key,
+                                         ARISR_UINT8 *data,
+                                         ARISR_UINT32 data_len,
+                                         ARISR_UINT32 *output_len);
+
+/**
+ * @brief Same as ARISR_aes_data_decrypt_inplace, with a pre-expanded key.
+ * 
+ * @param ctx[in]         Initialized key context
+ * @param data[in,out]    Ciphertext, replaced by the decrypted data
+ * @param data_len[in]    Length of ciphertext data (must be block-aligned)
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ */
+ARISR_ERR ARISR_aes_data_decrypt_inplace_ctx(const ARISR_KEY_CTX *ctx,
+                                             ARISR_UINT8 *data,
+                                             ARISR_UINT32 data_len,
+                                             ARISR_UINT32 *output_len);
+
+/**
+ * @brief AES-128 Decryption with PKCS#7 Padding Validation into a caller-supplied buffer
+ * 
+ * Same as ARISR_aes_data_decrypt, but the plaintext is written to 'output' without any
+ * heap allocation. 'output' only needs to hold the plaintext, not the padding, and
+ * 'input' and 'output' may be the same buffer.
+ * 
+ * @param key[in]         128-bit decryption key (same as encryption key)
+ * @param input[in]       Ciphertext data to decrypt
+ * @param input_len[in]   Length of ciphertext data (must be block-aligned)
+ * @param output[out]     Decrypted data buffer
+ * @param output_cap[in]  Capacity of the decrypted data buffer
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ * 
+ * @retval kARISR_OK                  Decryption successful
+ * @retval kARISR_ERR_INVALID_ARG     Invalid parameters
+ * @retval kARISR_ERR_BAD_PADDING     Invalid PKCS#7 padding
+ * @retval kARISR_ERR_BUFFER_OVERFLOW 'output_cap' is smaller than the decrypted length
+ */
+ARISR_ERR ARISR_aes_data_decrypt_into(const ARISR_AES128_KEY key,
+                                      const ARISR_UINT8 *input,
+                                      ARISR_UINT32 input_len,
+                                      ARISR_UINT8 *output,
+                                      ARISR_UINT32 output_cap,
+                                      ARISR_UINT32 *output_len);
+
+/**
+ * @brief Same as ARISR_aes_data_decrypt_into, with a pre-expanded key.
+ * 
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Ciphertext data to decrypt
+ * @param input_len[in]   Length of ciphertext data (must be block-aligned)
+ * @param output[out]     Decrypted data buffer
+ * @param output_cap[in]  Capacity of the decrypted data buffer
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ */
+ARISR_ERR ARISR_aes_data_decrypt_into_ctx(const ARISR_KEY_CTX *ctx,
+                                          const ARISR_UINT8 *input,
+                                          ARISR_UINT32 input_len,
+                                          ARISR_UINT8 *output,
+                                          ARISR_UINT32 output_cap,
+                                          ARISR_UINT32 *output_len);
+
+/**
+ * @brief Same as ARISR_aes_data_encrypt_into_ctx, adding the ciphertext to a running CRC.
+ *
+ * The data is padded, encrypted and fed to the CRC strip by strip (ARISR_AES_CRC_STRIP
+ * bytes), so each byte goes through memory once instead of once per pass.
+ *
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Plaintext data to encrypt
+ * @param input_len[in]   Length of plaintext data
+ * @param output[out]     Encrypted data buffer, 'input' itself or not overlapping it
+ * @param output_cap[in]  Capacity of the encrypted data buffer
+ * @param output_len[out] Length of encrypted data
+ * @param crc[in,out]     Running CRC, updated with the whole ciphertext on success
+ */
+ARISR_ERR ARISR_aes_data_encrypt_crc_into_ctx(const ARISR_KEY_CTX *ctx,
+                                              const ARISR_UINT8 *input,
+                                              ARISR_UINT32 input_len,
+                                              ARISR_UINT8 *output,
+                                              ARISR_UINT32 output_cap,
+                                              ARISR_UINT32 *output_len,
+                                              ARISR_CRC16_CTX *crc);
+
+/**
+ * @brief Same as ARISR_aes_data_decrypt_into_ctx, adding the ciphertext to a running CRC.
+ *
+ * Each strip is fed to the CRC and decrypted right away. The CRC covers the whole
+ * ciphertext when the result is kARISR_OK or kARISR_ERR_INVALID_PADDING, so the caller
+ * can report a CRC mismatch first: a damaged frame usually fails the padding too.
+ *
+ * @param ctx[in]         Initialized key context
+ * @param input[in]       Ciphertext data to decrypt
+ * @param input_len[in]   Length of ciphertext data (must be block-aligned)
+ * @param output[out]     Decrypted data buffer, 'input' itself or not overlapping it
+ * @param output_cap[in]  Capacity of the decrypted data buffer
+ * @param output_len[out] Length of decrypted data (excluding padding)
+ * @param crc[in,out]     Running CRC, updated with the ciphertext
+ */
+ARISR_ERR ARISR_aes_data_decrypt_crc_into_ctx(const ARISR_KEY_CTX *ctx,
+                                              const ARISR_UINT8 *input,
+                                              ARISR_UINT32 input_len,
+                                              ARISR_UINT8 *output,
+                                              ARISR_UINT32 output_cap,
+                                              ARISR_UINT32 *output_len,
+                                              ARISR_CRC16_CTX *crc);
 #endif
 
 /* COPYRIGHT ARIS Alliance */
\ No newline at end of file
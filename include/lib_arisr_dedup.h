@@ -0,0 +1,144 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_dedup.h
+ * @brief This file contains the duplicate frame cache of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_DEDUP_H
+#define LIB_ARISR_DEDUP_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+#include "lib_arisr_comm.h"
+#include "lib_arisr_crypt.h"
+#include "lib_arisr_alloc.h"
+
+// Entries per set, a set is 32 bytes so two share a cache line
+#define ARISR_DEDUP_WAYS            4
+
+// Times are kept on 32 bits, the window must stay below half of that range
+#define ARISR_DEDUP_MAX_WINDOW      0x7FFFFFFFUL
+
+// Lock-free entries need a 64-bit compare-and-swap. Without it (e.g. Cortex-M3) the cache
+// is built with plain accesses and must only be used by one thread at a time.
+#ifndef ARISR_DEDUP_ATOMIC64
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define ARISR_DEDUP_ATOMIC64        1
+#else
+#define ARISR_DEDUP_ATOMIC64        0
+#endif
+#endif
+
+/**
+ * @brief Cache of recently seen frames, keyed by (origin, identifier, sequence, header CRC).
+ *
+ * A set-associative table of 64-bit entries, each holding a 32-bit tag of the key
+ * and the 32 low bits of the time it was seen. A lookup hashes the key once,
+ * reads the ARISR_DEDUP_WAYS entries of its set and replaces the empty, expired
+ * or oldest one with a single compare-and-swap.
+ *
+ * Lock-free when ARISR_DEDUP_ATOMIC64 is set: any number of threads may check
+ * frames against the same cache. Two copies checked at the very same moment may
+ * both pass, and a lost race only forgets an entry, so a duplicate is at worst
+ * decoded again. A tag collision drops a new frame with a probability near 2^-32
+ * per lookup.
+ *
+ * Ages are computed on the 32 low bits of 'now', so an entry left untouched for
+ * 2^32 time units looks recent again. Pick a unit where 2^32 covers the life of the
+ * cache (about 49.7 days in milliseconds, 136 years in seconds), or call
+ * ARISR_dedup_clear more often than that.
+ */
+typedef struct {
+    ARISR_UINT64 *entries;                          // sets * ARISR_DEDUP_WAYS entries, 0 when empty
+    ARISR_UINT32 set_mask;                          // Number of sets - 1 (power of two)
+    ARISR_UINT32 window;                            // A copy seen within 'window' time units is a duplicate
+    ARISR_UINT32 duplicates;                        // Frames reported as duplicates (atomic)
+
+    ARISR_ALLOCATOR allocator;                      // Owner of 'entries'
+} ARISR_DEDUP;
+
+/**
+ * @brief Allocates a duplicate cache.
+ *
+ * @param dedup     [out] Cache to initialize.
+ * @param capacity  [in]  Frames remembered, rounded up to a power of two of at least ARISR_DEDUP_WAYS.
+ * @param window    [in]  Time a frame is remembered, 1 to ARISR_DEDUP_MAX_WINDOW in the unit of 'now'.
+ * @param allocator [in]  Allocator for the table, NULL for malloc.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if the allocation fails.
+ *
+ * @note Release it with ARISR_dedup_destroy.
+ */
+ARISR_ERR ARISR_dedup_create(ARISR_DEDUP *dedup, ARISR_UINT32 capacity, ARISR_UINT32 window, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Releases the table of a cache and zeroes it. No other thread may use it anymore.
+ *
+ * @param dedup [in] Cache to destroy.
+ */
+void ARISR_dedup_destroy(ARISR_DEDUP *dedup);
+
+/**
+ * @brief Forgets every frame. No other thread may use the cache meanwhile.
+ *
+ * @param dedup [in] Cache from ARISR_dedup_create.
+ */
+void ARISR_dedup_clear(ARISR_DEDUP *dedup);
+
+/**
+ * @brief Records a frame header and tells whether it was already seen.
+ *
+ * @param dedup  [in] Cache from ARISR_dedup_create.
+ * @param header [in] Parsed header (origin, ctrl.identifier, ctrl.sequence and crc_header are read).
+ * @param now    [in] Current time, never going backwards by more than 'window' (only its 32 low bits are kept).
+ * @return kARISR_OK for a new frame, kARISR_ERR_DUPLICATE if it was seen within the window,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_dedup_check(ARISR_DEDUP *dedup, const ARISR_CHUNK *header, ARISR_UINT64 now);
+
+/**
+ * @brief Same as ARISR_proto_parse_len_ctx, dropping duplicates right after the header CRC.
+ *
+ * A duplicate costs the header CRC only: its data is neither checked nor decrypted.
+ *
+ * @param dedup  [in]  Cache from ARISR_dedup_create.
+ * @param now    [in]  Current time, in the unit of the window.
+ * @param buffer [out] Pointer to the ARISR_CHUNK structure where parsed data will be stored and decrypted.
+ * @param data   [in]  Pointer to the raw input data buffer (e.g., from the network or file).
+ * @param length [in]  Number of bytes available in 'data'.
+ * @param ctx    [in]  Key context from ARISR_aes_key_ctx_init.
+ * @param id     [in]  The expected Network ID section to match the incoming data.
+ * @return kARISR_OK on success, kARISR_ERR_DUPLICATE (nothing to clean),
+ *         or the same error codes as ARISR_proto_parse_len.
+ *
+ * @note A frame is only recorded once fully parsed, so a copy with corrupted data does not
+ *       hide a later good one.
+ */
+ARISR_ERR ARISR_dedup_parse_len_ctx(ARISR_DEDUP *dedup, ARISR_UINT64 now, ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length,
+                                    const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
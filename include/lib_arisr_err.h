@@ -56,6 +56,9 @@ typedef ARISR_UINT32	ARISR_ERR;
 #define kARISR_ERR_BUFFER_OVERFLOW         (ARISR_ERR)10
 #define kARISR_ERR_NULL_ORIGIN             (ARISR_ERR)11
 #define kARISR_ERR_NULL_DESTINATION        (ARISR_ERR)12
+#define kARISR_ERR_INVALID_LENGTH          (ARISR_ERR)13
+#define kARISR_ERR_DUPLICATE               (ARISR_ERR)14
+#define kARISR_ERR_NOT_ADDRESSED           (ARISR_ERR)15
 
 /******************************************************************************/
 
@@ -73,7 +76,10 @@ static const char *ARISR_ERR_NAMES[] __attribute__((unused)) = {
     "kARISR_ERR_NOT_SAME_END",
     "kARISR_ERR_BUFFER_OVERFLOW",
     "kARISR_ERR_NULL_ORIGIN",
-    "kARISR_ERR_NULL_DESTINATION"
+    "kARISR_ERR_NULL_DESTINATION",
+    "kARISR_ERR_INVALID_LENGTH",
+    "kARISR_ERR_DUPLICATE",
+    "kARISR_ERR_NOT_ADDRESSED"
 };
 
 #endif
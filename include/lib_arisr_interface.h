@@ -52,6 +52,13 @@
 
 #define ARISR_CRC_SIZE              2
 
+// Frame size bounds (ID + ARIS + CTRL1 + ORIGIN + DEST A + CRC + END, up to all the optional sections)
+#define ARISR_PROTO_MAX_DESTINATIONS    255
+#define ARISR_PROTO_MAX_DATA_LENGTH     (255 * ARISR_DATA_MULT)
+#define ARISR_PROTO_MIN_FRAME_SIZE      (ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2 + ARISR_CRC_SIZE + ARISR_PROTO_ID_SIZE)
+#define ARISR_PROTO_MAX_FRAME_SIZE      (ARISR_PROTO_MIN_FRAME_SIZE + ARISR_PROTO_MAX_DESTINATIONS * ARISR_ADDRESS_SIZE + ARISR_ADDRESS_SIZE + \
+                                         ARISR_CTRL2_SECTION_SIZE + ARISR_PROTO_MAX_DATA_LENGTH + ARISR_CRC_SIZE)
+
 /* CTRL 1*/
 
 #define ARISR_CTRL_VERSION_MASK     0xF0000000
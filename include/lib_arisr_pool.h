@@ -0,0 +1,128 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_pool.h
+ * @brief This file contains the multi-threaded batch decoder of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_POOL_H
+#define LIB_ARISR_POOL_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+#include "lib_arisr_comm.h"
+#include "lib_arisr_crypt.h"
+
+// Worker pool on POSIX threads. Bare-metal targets build without it.
+#ifndef ARISR_POOL_THREADS
+#if defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+#define ARISR_POOL_THREADS          1
+#else
+#define ARISR_POOL_THREADS          0
+#endif
+#endif
+
+#if ARISR_POOL_THREADS
+
+#define ARISR_POOL_MAX_WORKERS      64
+
+// Frames per task, the unit a worker pops from its own deque or steals from another one
+#ifndef ARISR_POOL_GRAIN
+#define ARISR_POOL_GRAIN            16
+#endif
+
+/**
+ * @brief Worker pool decoding batches of frames in parallel.
+ *
+ * Each worker owns an expanded copy of the network key, an arena for the decoded
+ * fields and a deque of tasks. A batch is split into tasks of ARISR_POOL_GRAIN
+ * frames dealt in contiguous ranges to the workers. A worker takes its own tasks
+ * from the back of its deque and, once empty, steals half of the remaining tasks
+ * from the front of another worker's deque.
+ *
+ * Result 'i' always belongs to frame 'i', whichever worker decoded it.
+ */
+typedef struct ARISR_POOL ARISR_POOL;
+
+/**
+ * @brief Starts a pool of 'workers' threads.
+ *
+ * @param pool           [out] New pool.
+ * @param workers        [in]  Number of threads, 1 to ARISR_POOL_MAX_WORKERS.
+ * @param key            [in]  The AES-128 network key, expanded once by every worker.
+ * @param arena_capacity [in]  Arena bytes per worker (ARISR_ARENA_CHUNK_SIZE per frame is
+ *                             the worst case). Fields that do not fit go to the heap.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if
+ *         memory or threads cannot be obtained.
+ *
+ * @note Stop it with ARISR_pool_destroy.
+ */
+ARISR_ERR ARISR_pool_create(ARISR_POOL **pool, ARISR_UINT32 workers, const ARISR_AES128_KEY key, ARISR_UINT32 arena_capacity);
+
+/**
+ * @brief Stops the threads and releases the pool, including the memory of the last results.
+ *
+ * @param pool [in] Pool to destroy.
+ */
+void ARISR_pool_destroy(ARISR_POOL *pool);
+
+/**
+ * @brief Parses 'count' frames with ARISR_proto_parse_len on the workers of the pool.
+ *
+ * @param pool    [in]  Pool from ARISR_pool_create.
+ * @param frames  [in]  Frames to parse.
+ * @param lengths [in]  Number of bytes available in each frame.
+ * @param count   [in]  Number of frames.
+ * @param id      [in]  The expected Network ID section to match the incoming data.
+ * @param results [out] One chunk per frame, in input order.
+ * @param status  [out] Result of each frame, in input order.
+ * @return kARISR_OK when the batch was processed (see 'status' for each frame),
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ *
+ * @note The fields of 'results' live in the pool: they stay valid until the next batch
+ *       on the same pool or ARISR_pool_destroy. Do not release them with ARISR_proto_chunk_clean.
+ * @note Calls on the same pool are serialized. Use one pool per ingest thread to run them concurrently.
+ */
+ARISR_ERR ARISR_pool_parse(ARISR_POOL *pool, const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                           ARISR_UINT8 *id, ARISR_CHUNK results[], ARISR_ERR status[]);
+
+#if defined(ARISR_PROTO_PARTIAL_FUNCTIONS)
+
+/**
+ * @brief Same as ARISR_pool_parse, with ARISR_proto_recv_len on every frame.
+ *
+ * @note The fields of 'results' live in the pool: they stay valid until the next batch
+ *       on the same pool or ARISR_pool_destroy. Do not release them with ARISR_proto_raw_chunk_clean.
+ */
+ARISR_ERR ARISR_pool_recv(ARISR_POOL *pool, const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                          ARISR_UINT8 *id, ARISR_CHUNK_RAW results[], ARISR_ERR status[]);
+
+#endif // ARISR_PROTO_PARTIAL_FUNCTIONS
+
+#endif // ARISR_POOL_THREADS
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,182 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_reasm.h
+ * @brief This file contains the fragment reassembly of the ARISr protocol (more_data sequences).
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_REASM_H
+#define LIB_ARISR_REASM_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+#include "lib_arisr_comm.h"
+#include "lib_arisr_alloc.h"
+
+// A message has at most one fragment per value of the 6-bit sequence
+#define ARISR_REASM_MAX_FRAGMENTS   (1 << ARISR_CTRL_SEQUENCE_BITS)
+
+// No slot / no slab
+#define ARISR_REASM_NONE            0xFFFF
+
+/**
+ * @brief Message handed back by ARISR_reasm_push once its last fragment is in.
+ *
+ * iov[0 .. count) are the fragments in sequence order. They point into the
+ * reassembler (or into the chunk for a single-frame message) and stay valid
+ * until ARISR_reasm_release.
+ */
+typedef struct {
+    ARISR_UINT48 origin;
+    ARISR_UINT8 identifier;
+    ARISR_UINT32 length;                            // Sum of every iov length
+    ARISR_UINT32 count;                             // 0 when no message is ready
+    ARISR_IOVEC iov[ARISR_REASM_MAX_FRAGMENTS];
+    ARISR_UINT16 slot;                              // Internal, ARISR_REASM_NONE for a single frame
+} ARISR_REASM_MESSAGE;
+
+/**
+ * @brief Message being reassembled. Internal to ARISR_REASM.
+ */
+typedef struct {
+    ARISR_UINT48 origin;
+    ARISR_UINT8 identifier;
+    ARISR_UINT8 last;                               // Sequence of the more_data = 0 fragment, 0xFF until it arrives
+    ARISR_UINT8 state;                              // Free, pending or delivered
+    ARISR_UINT64 received;                          // Bit 's' set when sequence 's' is in
+    ARISR_UINT64 created;                           // Time of the first fragment
+    ARISR_UINT16 prev;                              // Age list, oldest first
+    ARISR_UINT16 next;
+    ARISR_UINT16 slab[ARISR_REASM_MAX_FRAGMENTS];
+    ARISR_UINT16 length[ARISR_REASM_MAX_FRAGMENTS];
+} ARISR_REASM_ENTRY;
+
+/**
+ * @brief Reassembler of more_data sequences, keyed by (origin, identifier).
+ *
+ * Every piece of memory is taken at ARISR_reasm_create: 'max_messages' entries,
+ * an open-addressing index and 'slab_count' slabs of 'slab_size' bytes. Each
+ * fragment is copied once, into the slab of its sequence, so fragments can arrive
+ * in any order. Messages older than 'timeout' are evicted on the next push, and
+ * the oldest message is evicted early when entries or slabs run out.
+ *
+ * Not thread-safe: use one per thread or lock around it.
+ */
+typedef struct {
+    ARISR_UINT32 max_messages;
+    ARISR_UINT32 slab_count;
+    ARISR_UINT32 slab_size;
+    ARISR_UINT64 timeout;                           // Same unit as the 'now' given to ARISR_reasm_push
+
+    ARISR_REASM_ENTRY *entries;
+    ARISR_UINT16 *index;                            // Entry of each hash bucket, ARISR_REASM_NONE if empty
+    ARISR_UINT32 index_mask;
+    ARISR_UINT8 index_shift;                        // 64 - log2(number of buckets), keeps the top bits of the hash
+    ARISR_UINT16 *free_entries;                     // Stack of free entries
+    ARISR_UINT32 free_entry_count;
+    ARISR_UINT16 *free_slabs;                       // Stack of free slabs
+    ARISR_UINT32 free_slab_count;
+    ARISR_UINT8 *slabs;
+    ARISR_UINT16 oldest;                            // Age list of the pending entries
+    ARISR_UINT16 newest;
+
+    ARISR_UINT32 completed;                         // Messages handed back
+    ARISR_UINT32 evicted;                           // Incomplete messages dropped (timeout or no room)
+    ARISR_UINT32 duplicates;                        // Fragments received twice
+
+    ARISR_ALLOCATOR allocator;                      // Owner of 'memory'
+    void *memory;
+} ARISR_REASM;
+
+/**
+ * @brief Allocates a reassembler in a single block.
+ *
+ * @param reasm        [out] Reassembler to initialize.
+ * @param max_messages [in]  Messages reassembled at the same time (1 to 65534).
+ * @param slab_count   [in]  Fragments stored at the same time (1 to 65534).
+ * @param slab_size    [in]  Largest fragment payload, ARISR_PROTO_MAX_DATA_LENGTH fits any frame.
+ * @param timeout      [in]  Age after which an incomplete message is evicted, 0 to keep them until room is needed.
+ * @param allocator    [in]  Allocator for the block, NULL for malloc.
+ * @return kARISR_OK on success, kARISR_ERR_INVALID_ARGUMENT or kARISR_ERR_GENERIC if the allocation fails.
+ *
+ * @note Release it with ARISR_reasm_destroy.
+ */
+ARISR_ERR ARISR_reasm_create(ARISR_REASM *reasm, ARISR_UINT32 max_messages, ARISR_UINT32 slab_count, ARISR_UINT32 slab_size,
+                             ARISR_UINT64 timeout, const ARISR_ALLOCATOR *allocator);
+
+/**
+ * @brief Releases the memory of a reassembler and zeroes it.
+ *
+ * @param reasm [in] Reassembler to destroy.
+ */
+void ARISR_reasm_destroy(ARISR_REASM *reasm);
+
+/**
+ * @brief Adds a parsed frame to its message.
+ *
+ * A frame with more_data = 0 and sequence 0 that starts no pending message is
+ * handed back at once, pointing to chunk->data without a copy.
+ *
+ * @param reasm   [in]  Reassembler from ARISR_reasm_create.
+ * @param chunk   [in]  Frame from ARISR_proto_parse (or any variant).
+ * @param now     [in]  Current time, in the unit of 'timeout'.
+ * @param message [out] Complete message when message->count > 0. Release it with ARISR_reasm_release.
+ * @return kARISR_OK when the fragment was taken (duplicates included),
+ *         kARISR_ERR_BUFFER_OVERFLOW if it is larger than 'slab_size',
+ *         kARISR_ERR_INVALID_ARGUMENT if its sequence is not below ARISR_REASM_MAX_FRAGMENTS,
+ *         or kARISR_ERR_GENERIC for NULL parameters or if no room can be made.
+ */
+ARISR_ERR ARISR_reasm_push(ARISR_REASM *reasm, const ARISR_CHUNK *chunk, ARISR_UINT64 now, ARISR_REASM_MESSAGE *message);
+
+/**
+ * @brief Evicts every incomplete message older than the timeout.
+ *
+ * @param reasm [in] Reassembler from ARISR_reasm_create.
+ * @param now   [in] Current time, in the unit of 'timeout'.
+ */
+void ARISR_reasm_expire(ARISR_REASM *reasm, ARISR_UINT64 now);
+
+/**
+ * @brief Gives the slabs of a delivered message back to the reassembler.
+ *
+ * @param reasm   [in] Reassembler that returned the message.
+ * @param message [in] Message from ARISR_reasm_push, cleared on return.
+ */
+void ARISR_reasm_release(ARISR_REASM *reasm, ARISR_REASM_MESSAGE *message);
+
+/**
+ * @brief Copies a reassembled message into one contiguous buffer.
+ *
+ * @param message  [in]  Message from ARISR_reasm_push.
+ * @param output   [out] Buffer receiving the payload.
+ * @param capacity [in]  Size of 'output', message->length is enough.
+ * @return kARISR_OK on success, kARISR_ERR_BUFFER_OVERFLOW if 'output' is too small,
+ *         or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_reasm_copy(const ARISR_REASM_MESSAGE *message, ARISR_UINT8 *output, ARISR_UINT32 capacity);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,153 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_scan.h
+ * @brief This file contains the byte-stream frame scanner of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#ifndef LIB_ARISR_SCAN_H
+#define LIB_ARISR_SCAN_H
+
+#include <stdint.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_interface.h"
+#include "lib_arisr_crypt.h"
+
+// Frame start search: SSE2 (16 bytes per step) with an AVX2 path (32 bytes) picked at
+// run time on x86, NEON (16 bytes) on ARM, otherwise a portable scalar loop. Every
+// path returns the same offset. Set -DARISR_SCAN_SIMD=0 to keep only the scalar loop.
+#ifndef ARISR_SCAN_SIMD
+  #define ARISR_SCAN_SIMD 1
+#endif
+
+#if ARISR_SCAN_SIMD && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))) && (defined(__GNUC__) || defined(__clang__))
+  #define ARISR_SCAN_SIMD_X86 1
+#else
+  #define ARISR_SCAN_SIMD_X86 0
+#endif
+
+#if ARISR_SCAN_SIMD && !ARISR_SCAN_SIMD_X86 && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__GNUC__) || defined(__clang__))
+  #define ARISR_SCAN_SIMD_NEON 1
+#else
+  #define ARISR_SCAN_SIMD_NEON 0
+#endif
+
+// A frame starts with the network ID followed by the key-shifted "ARIS"
+#define ARISR_SCANNER_PATTERN_SIZE      ARISR_PROTO_CRYPT_SIZE
+
+// Twice the largest frame, so compacting the window costs O(1) per byte
+#define ARISR_SCANNER_BUFFER_SIZE       (2 * ARISR_PROTO_MAX_FRAME_SIZE)
+
+// The "ARIS" bytes are all different, two starts are at least 4 bytes apart
+#define ARISR_SCANNER_MAX_CANDIDATES    (ARISR_SCANNER_BUFFER_SIZE / ARISR_PROTO_ARIS_SIZE + 1)
+
+/**
+ * @brief Called for every complete frame found in the stream.
+ *
+ * 'frame' has a matching ID, ARIS, header CRC and end mark and is exactly 'length'
+ * bytes long, ready for ARISR_proto_parse_len. It is only valid during the call.
+ */
+typedef void (*ARISR_SCANNER_CB)(void *user, const ARISR_UINT8 *frame, ARISR_UINT32 length);
+
+/**
+ * @brief Incremental frame scanner for delimiter-less byte streams (serial, USB, captures).
+ *
+ * Frame starts are located with ARISR_scanner_find, and a KMP automaton carries
+ * a start split between two chunks, so every byte is looked at once while
+ * hunting and nothing outside a candidate frame is copied. A frame that lies
+ * completely inside the pushed chunk is checked and emitted in place. Otherwise
+ * the candidate is assembled in 'buffer', and the automaton keeps recording
+ * later frame starts in it: on a header CRC or end mark mismatch the scanner
+ * jumps to the next recorded start instead of rescanning the bytes.
+ *
+ * The scanner holds no pointers and can be placed in static memory. It is not
+ * thread-safe: use one per stream.
+ */
+typedef struct {
+    ARISR_UINT8 pattern[ARISR_SCANNER_PATTERN_SIZE];        // ID + encrypted ARIS
+    ARISR_UINT8 fail[ARISR_SCANNER_PATTERN_SIZE + 1];       // KMP failure function of 'pattern'
+    ARISR_UINT8 match;                                      // Pattern bytes matched by the latest input
+
+    ARISR_UINT8 header_ok;                                  // Header CRC of the candidate already checked
+    ARISR_UINT32 need;                                      // Bytes the candidate needs before the next check
+    ARISR_UINT32 start;                                     // Candidate being assembled: buffer[start, end)
+    ARISR_UINT32 end;
+    ARISR_UINT32 cand_head;                                 // Later frame starts: candidates[cand_head, cand_count)
+    ARISR_UINT32 cand_count;
+    ARISR_UINT16 candidates[ARISR_SCANNER_MAX_CANDIDATES];
+    ARISR_UINT8 buffer[ARISR_SCANNER_BUFFER_SIZE];
+
+    ARISR_UINT32 frames;                                    // Frames emitted
+    ARISR_UINT32 resyncs;                                   // Candidates rejected
+} ARISR_SCANNER;
+
+/**
+ * @brief Initializes a scanner for the network 'id' and the key of 'ctx'.
+ *
+ * @param scanner [out] Scanner to initialize.
+ * @param ctx     [in]  Key context from ARISR_aes_key_ctx_init, only read here.
+ * @param id      [in]  The Network ID section that starts and ends every frame.
+ * @return kARISR_OK on success, or kARISR_ERR_INVALID_ARGUMENT for NULL parameters.
+ */
+ARISR_ERR ARISR_scanner_init(ARISR_SCANNER *scanner, const ARISR_KEY_CTX *ctx, const ARISR_UINT8 *id);
+
+/**
+ * @brief Drops the partial frame and the counters, e.g. after reopening the port.
+ *
+ * @param scanner [in] Scanner to reset.
+ */
+void ARISR_scanner_reset(ARISR_SCANNER *scanner);
+
+/**
+ * @brief Finds the first frame start (network ID + encrypted ARIS) in a buffer.
+ *
+ * Only the first ID byte and the first ARIS byte are compared with SIMD, the
+ * full 8 bytes are checked on those hits. Useful on its own to walk a capture
+ * file: the header CRC is then only computed on real candidates.
+ *
+ * @param scanner [in] Scanner from ARISR_scanner_init (only the pattern is read).
+ * @param data    [in] Bytes to search.
+ * @param length  [in] Number of bytes in 'data'.
+ * @return Offset of the first complete start, or 'length' if there is none.
+ */
+ARISR_UINT32 ARISR_scanner_find(const ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length);
+
+/**
+ * @brief Feeds 'length' bytes of the stream to the scanner.
+ *
+ * Chunks may be of any size and split frames anywhere. 'callback' is called in
+ * stream order for every complete frame, and must not push to the same scanner.
+ *
+ * @param scanner  [in] Scanner from ARISR_scanner_init.
+ * @param data     [in] Next bytes of the stream.
+ * @param length   [in] Number of bytes in 'data'.
+ * @param callback [in] Receives every complete frame.
+ * @param user     [in] Handed back untouched to 'callback'.
+ * @return kARISR_OK on success, or kARISR_ERR_GENERIC for NULL parameters.
+ */
+ARISR_ERR ARISR_scanner_push(ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length, ARISR_SCANNER_CB callback, void *user);
+
+#endif
+
+/* COPYRIGHT ARIS Alliance */
@@ -34,6 +34,7 @@
 #include "lib_arisr_comm.h"
 #include "lib_arisr_err.h"
 #include "lib_arisr_crypt.h"
+#include "lib_arisr_alloc.h"
 #include "lib_arisr.h"
 
 
@@ -84,33 +85,33 @@ ARISR_ERR ARISR_proto_ctrl_setField(ARISR_UINT8 *ctrl, ARISR_UINT8 data, ARISR_U
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_raw_chunk_clean(ARISR_CHUNK_RAW *buffer)
+ARISR_ERR ARISR_proto_raw_chunk_clean_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_ALLOCATOR *allocator)
 {
-    if (!buffer) {
+    if (!buffer || !allocator) {
         return kARISR_ERR_GENERIC;
     }
 
     // Free destinationsB array if allocated
     if (buffer->destinationsB) {
-        free(buffer->destinationsB);
+        ARISR_FREE(allocator, buffer->destinationsB);
         buffer->destinationsB = NULL;
     }
 
     // Free destinationsC if allocated
     if (buffer->destinationC) {
-        free(buffer->destinationC);
+        ARISR_FREE(allocator, buffer->destinationC);
         buffer->destinationC = NULL;
     }
 
     // Free ctrl2 array if allocated
     if (buffer->ctrl2) {
-        free(buffer->ctrl2);
+        ARISR_FREE(allocator, buffer->ctrl2);
         buffer->ctrl2 = NULL;
     }
 
     // Free data array if allocated
     if (buffer->data) {
-        free(buffer->data);
+        ARISR_FREE(allocator, buffer->data);
         buffer->data = NULL;
     }
 
@@ -120,33 +121,177 @@ ARISR_ERR ARISR_proto_raw_chunk_clean(ARISR_CHUNK_RAW *buffer)
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_chunk_clean(ARISR_CHUNK *buffer)
+ARISR_ERR ARISR_proto_raw_chunk_clean(ARISR_CHUNK_RAW *buffer)
+{
+    return ARISR_proto_raw_chunk_clean_alloc(buffer, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_chunk_clean_alloc(ARISR_CHUNK *buffer, const ARISR_ALLOCATOR *allocator)
 {
-    if (!buffer) {
+    if (!buffer || !allocator) {
         return kARISR_ERR_GENERIC;
     }
 
     // Free destinationsB array if allocated
     if (buffer->destinationsB) {
-        free(buffer->destinationsB);
+        ARISR_FREE(allocator, buffer->destinationsB);
         buffer->destinationsB = NULL;
     }
 
     // Free data array if allocated
     if (buffer->data) {
-        free(buffer->data);
+        ARISR_FREE(allocator, buffer->data);
         buffer->data = NULL;
     }
 
     // Reset the structure to zero
-    memset(buffer, 0, sizeof(ARISR_CHUNK_RAW));
+    memset(buffer, 0, sizeof(ARISR_CHUNK));
     return kARISR_OK;
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+ARISR_ERR ARISR_proto_chunk_clean(ARISR_CHUNK *buffer)
 {
-    if (!buffer || !data) {
+    return ARISR_proto_chunk_clean_alloc(buffer, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_header_size_raw(const ARISR_UINT8 *ctrl, ARISR_UINT32 *length)
+{
+    ARISR_UINT32 size;
+
+    if (!ctrl || !length) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    // ID + ARIS + CTRL1 + ORIGIN + DEST A
+    size = ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2;
+
+    // Destinations B
+    size += ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT) * ARISR_ADDRESS_SIZE;
+
+    // Destination C
+    if (ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT)) {
+        size += ARISR_ADDRESS_SIZE;
+    }
+
+    // CTRL2
+    if (ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT)) {
+        size += ARISR_CTRL2_SECTION_SIZE;
+    }
+
+    *length = size;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_frame_size_raw(const ARISR_UINT8 *ctrl, const ARISR_UINT8 *ctrl2, ARISR_UINT32 *length)
+{
+    ARISR_ERR err;
+    ARISR_UINT32 size, data_length;
+
+    if ((err = ARISR_proto_header_size_raw(ctrl, &size)) != kARISR_OK) {
+        return err;
+    }
+
+    // CRC header + END
+    size += ARISR_CRC_SIZE + ARISR_PROTO_ID_SIZE;
+
+    // Data section and its CRC, as announced by CTRL2
+    if (ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT)) {
+        if (!ctrl2) {
+            return kARISR_ERR_INVALID_ARGUMENT;
+        }
+
+        data_length = ARISR_proto_ctrl_getField(ctrl2, ARISR_CTRL2_DATA_LENGTH_MASK, ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT;
+        if (data_length > 0) {
+            size += data_length + ARISR_CRC_SIZE;
+        }
+    }
+
+    *length = size;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_frame_size(const ARISR_CHUNK *data, ARISR_UINT32 *length)
+{
+    ARISR_UINT32 size, encrypted_length;
+
+    if (!data || !length) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    // Minimun size of the buffer
+    size = ARISR_PROTO_MIN_FRAME_SIZE;
+
+    // Calculate the destinations
+    size += data->ctrl.destinations * ARISR_ADDRESS_SIZE;
+
+    // Get from
+    if (data->ctrl.from) {
+        size += ARISR_ADDRESS_SIZE;
+    }
+
+    // Get more headers
+    if (data->ctrl.more_header) {
+        size += ARISR_CTRL2_SECTION_SIZE;
+
+        // PKCS#7 always adds between 1 and AES_BLOCKLEN bytes of padding
+        if (data->ctrl2.data_length > 0) {
+            encrypted_length = data->ctrl2.data_length + (ARISR_AES128_BLOCK_SIZE - (data->ctrl2.data_length % ARISR_AES128_BLOCK_SIZE));
+
+            // The encrypted length must fit in the CTRL2 data length field
+            if (encrypted_length < data->ctrl2.data_length || encrypted_length > ARISR_PROTO_MAX_DATA_LENGTH) {
+                return kARISR_ERR_INVALID_ARGUMENT;
+            }
+
+            size += encrypted_length + ARISR_CRC_SIZE;
+        }
+    }
+
+    *length = size;
+
+    return kARISR_OK;
+}
+
+// =============================================
+static ARISR_ERR ARISR_proto_check_length(const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    ARISR_UINT32 size, header;
+    const ARISR_UINT8 *ctrl;
+
+    // 1- ID, ARIS and CTRL1 are needed to predict the rest of the frame
+    if (length < ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+    ctrl = data + ARISR_PROTO_CRYPT_SIZE;
+
+    // 2- Header size up to the CRC header, as described by CTRL1
+    ARISR_proto_header_size_raw(ctrl, &header);
+    if (length < header) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+
+    // 3- CTRL2 (if any) is the last section of the header and gives the data section size
+    ARISR_proto_frame_size_raw(ctrl, data + header - ARISR_CTRL2_SECTION_SIZE, &size);
+
+    // 4- Short and oversized frames are rejected
+    if (size != length) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+
+    return kARISR_OK;
+}
+
+// =============================================
+static ARISR_ERR ARISR_proto_parse_filtered(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id,
+                                            ARISR_HEADER_FILTER filter, void *user, const ARISR_ALLOCATOR *allocator)
+{
+    if (!buffer || !data || !ctx || !allocator) {
         return kARISR_ERR_GENERIC;
     }
 
@@ -160,7 +305,6 @@ ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const
     unsigned int p = 0, err;
 
     // Field placeholders
-    ARISR_UINT8 ctrl[4];
     ARISR_UINT16 crc;
 
     /* =============== ID & ARIS ================= */
@@ -175,276 +319,998 @@ ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const
     }
 
     // Decrypt the 'aris' field using the last byte of the key
-    if (ARISR_aes_aris_decrypt(key, buffer->aris) != kARISR_OK) {
+    if (ARISR_aes_aris_decrypt_ctx(ctx, buffer->aris) != kARISR_OK) {
         return kARISR_ERR_NOT_SAME_ARIS;
     }
 
-    p += ARISR_PROTO_CRYPT_SIZE;
-
-    /* =============== CTRL 1 ================= */
-    // 2- Allocate and copy the first control section (CTRL1).
-    memcpy(ctrl, data + p, ARISR_CTRL_SECTION_SIZE);
-    p += ARISR_CTRL_SECTION_SIZE;
+    p += ARISR_PROTO_CRYPT_SIZE;
+
+    /* =============== CTRL 1 ================= */
+    // 2- Decode the first control section (CTRL1) in place.
+    ARISR_proto_ctrl_decode(data + p, &buffer->ctrl);
+    p += ARISR_CTRL_SECTION_SIZE;
+
+    /* =============== ORIGIN & DESTINATION ================= */
+    // 3- Copy origin (6 bytes) and destinationA (6 bytes)
+    memcpy(buffer->origin, data + p, ARISR_ADDRESS_SIZE * 2);
+    p += ARISR_ADDRESS_SIZE * 2;
+
+    /* =============== DESTINATIONS B ================= */
+    // 4- Copy the next 'destinations' addresses (each 6 bytes)
+    if (buffer->ctrl.destinations > 0) {
+        buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE])
+                                 ARISR_ALLOC(allocator, buffer->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
+        if (!buffer->destinationsB) {
+            ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
+        }
+        memcpy(buffer->destinationsB, data + p, buffer->ctrl.destinations * ARISR_ADDRESS_SIZE);
+        p += buffer->ctrl.destinations * ARISR_ADDRESS_SIZE;
+    }
+
+    /* =============== DESTINATION C ================= */
+    // 5- If 'from_relay' is set, copy the 'destinationC' field (6 bytes)
+    memset(buffer->destinationC, '\0', ARISR_ADDRESS_SIZE);
+    if (buffer->ctrl.from) {
+        memcpy(buffer->destinationC, data + p, ARISR_ADDRESS_SIZE);
+        p += ARISR_ADDRESS_SIZE;
+    }
+
+    /* ================= CTRL 2 ===================== */
+    // 6- If 'more_headers' is set, we allocate and copy CTRL2
+    if (buffer->ctrl.more_header) {
+        ARISR_proto_ctrl2_decode(data + p, &buffer->ctrl2);
+        p += ARISR_CTRL2_SECTION_SIZE;
+    } else {
+        memset(&buffer->ctrl2, '\0', ARISR_CTRL2_SECTION_SIZE);
+    }
+
+    /* =============== CRC HEADER ================= */
+    // 7- Copy the 2-byte CRC for the header
+    memcpy(buffer->crc_header, data + p, ARISR_CRC_SIZE);
+
+    // Convert 'crc_header' (2 bytes) into an ARISR_UINT16 for comparison
+    ARISR_UINT16 expected_crc_header = ((ARISR_UINT16)buffer->crc_header[0] << 8) 
+                                     | buffer->crc_header[1];
+
+    // Calculate CRC over the entire header portion from index 0 to p-1
+    // 'p' currently points at the start of the CRC header, so the header size is 'p'.
+    crc = ARISR_crypt_crc16_calculate((const ARISR_UINT8*)data, p);
+    if (crc != expected_crc_header) {
+        ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_HEADER);
+    }
+    p += ARISR_CRC_SIZE;
+
+    // The header is trusted from here: let the caller drop the frame before the data CRC and decryption
+    if (filter && (err = filter(user, buffer)) != kARISR_OK) {
+        ARISR_CLEAN_ALLOC_AND_RETURN(err);
+    }
+
+    /* =============== DATA ================= */
+    // 8- If 'more_headers' is set, we parse the data section and decrypt it with its CRC
+    if (buffer->ctrl.more_header && buffer->ctrl2.data_length > 0) {
+        // Copy the 2-byte CRC for the data
+        memcpy(buffer->crc_data, data + p + buffer->ctrl2.data_length, ARISR_CRC_SIZE);
+
+        // Convert 'crc_data' (2 bytes) into an ARISR_UINT16 for comparison
+        ARISR_UINT16 expected_crc_data = ((ARISR_UINT16)buffer->crc_data[0] << 8) 
+                                       | buffer->crc_data[1];
+
+        // Data, decrypted straight from the frame into its own block while the CRC
+        // reads each ciphertext strip, so the payload is only read once
+        ARISR_UINT32 decrypted_length;
+        ARISR_CRC16_CTX data_crc;
+        buffer->data = (ARISR_UINT8*)ARISR_ALLOC(allocator, buffer->ctrl2.data_length);
+        if (!buffer->data) {
+            ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
+        }
+        ARISR_crypt_crc16_init(&data_crc);
+        if (buffer->ctrl2.data_length % ARISR_AES128_BLOCK_SIZE != 0) {
+            // Not a whole number of blocks, the CRC still decides which error is reported
+            ARISR_crypt_crc16_update(&data_crc, data + p, buffer->ctrl2.data_length);
+        }
+        err = ARISR_aes_data_decrypt_crc_into_ctx(ctx, data + p, buffer->ctrl2.data_length, buffer->data, buffer->ctrl2.data_length, &decrypted_length, &data_crc);
+
+        // A damaged payload is reported as such, even if its padding broke as well
+        if (ARISR_crypt_crc16_final(&data_crc) != expected_crc_data) {
+            ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_DATA);
+        }
+        if (err != kARISR_OK) {
+            ARISR_CLEAN_ALLOC_AND_RETURN(err);
+        }
+
+        // Move the pointer to the next section after the data
+        p += buffer->ctrl2.data_length + ARISR_CRC_SIZE;
+
+        // Update real data length decrypted
+        buffer->ctrl2.data_length = decrypted_length;
+    }
+
+    /* =============== END ================= */
+    // 9- Finally, copy the 4-byte 'end' field
+    memcpy(buffer->end, data + p, ARISR_PROTO_ID_SIZE);
+
+    // Check if 'end' is the same as the provided 'id'
+    if (memcmp(buffer->end, id, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_END;
+    }
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_ctx_alloc(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator)
+{
+    return ARISR_proto_parse_filtered(buffer, data, ctx, id, NULL, NULL, allocator);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    return ARISR_proto_parse_ctx_alloc(buffer, data, ctx, id, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_parse_ctx(buffer, data, &ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_ctx_alloc(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator)
+{
+    ARISR_ERR err;
+
+    if (!buffer || !data) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    memset(buffer, 0, sizeof(ARISR_CHUNK));
+
+    // Reject short or oversized frames before any CRC, copy or allocation
+    if ((err = ARISR_proto_check_length(data, length)) != kARISR_OK) {
+        return err;
+    }
+
+    return ARISR_proto_parse_ctx_alloc(buffer, data, ctx, id, allocator);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    return ARISR_proto_parse_len_ctx_alloc(buffer, data, length, ctx, id, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_len(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_parse_len_ctx(buffer, data, length, &ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_filtered_ctx(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id,
+                                             ARISR_HEADER_FILTER filter, void *user)
+{
+    ARISR_ERR err;
+
+    if (!buffer || !data) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    memset(buffer, 0, sizeof(ARISR_CHUNK));
+
+    // Reject short or oversized frames before any CRC, copy or allocation
+    if ((err = ARISR_proto_check_length(data, length)) != kARISR_OK) {
+        return err;
+    }
+
+    return ARISR_proto_parse_filtered(buffer, data, ctx, id, filter, user, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_filtered(ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id,
+                                         ARISR_HEADER_FILTER filter, void *user)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_parse_len_filtered_ctx(buffer, data, length, &ctx, id, filter, user);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_relay_rewrite(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length,
+                                    const ARISR_UINT8 *data, ARISR_UINT32 data_length, const ARISR_UINT8 *id, const ARISR_UINT8 *relay)
+{
+    ARISR_CHUNK_CTRL ctrl;
+    ARISR_UINT32 header, addresses, ctrl2, size;
+    ARISR_UINT16 crc;
+    ARISR_ERR err;
+
+    if (!buffer || !length || !data || !id || !relay) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    // The tail is moved before the header is copied, which only works in place or between separate buffers
+    if (buffer != data && (uintptr_t)buffer < (uintptr_t)data + data_length && (uintptr_t)data < (uintptr_t)buffer + capacity) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((err = ARISR_proto_check_length(data, data_length)) != kARISR_OK) {
+        return err;
+    }
+
+    // The frame must be one of ours and its header intact, the rest is forwarded as is
+    if (memcmp(data, id, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_ID;
+    }
+    if (memcmp(data + data_length - ARISR_PROTO_ID_SIZE, id, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_END;
+    }
+
+    ARISR_proto_ctrl_decode(data + ARISR_PROTO_CRYPT_SIZE, &ctrl);
+    ARISR_proto_header_size_raw(data + ARISR_PROTO_CRYPT_SIZE, &header);
+    if (ARISR_crypt_crc16_calculate(data, header) != (((ARISR_UINT16)data[header] << 8) | data[header + 1])) {
+        return kARISR_ERR_NOT_SAME_CRC_HEADER;
+    }
+
+    // ID + ARIS + CTRL1 + ORIGIN + DEST A + DESTS B, where DEST C goes
+    addresses = ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2 + ctrl.destinations * ARISR_ADDRESS_SIZE;
+    ctrl2 = ctrl.more_header ? ARISR_CTRL2_SECTION_SIZE : 0;
+
+    // Inserting DEST C makes the frame 6 bytes longer, replacing it keeps the size
+    size = ctrl.from ? data_length : data_length + ARISR_ADDRESS_SIZE;
+    *length = size;
+    if (capacity < size) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+
+    // CTRL2, the ciphertext, its CRC and END move as one block, then the start of the header
+    memmove(buffer + addresses + ARISR_ADDRESS_SIZE, data + (header - ctrl2), data_length - (header - ctrl2));
+    if (buffer != data) {
+        memmove(buffer, data, addresses);
+    }
+
+    /* =============== CTRL 1 & DESTINATION C ================= */
+    ctrl.from = 1;
+    ARISR_proto_ctrl_encode(buffer + ARISR_PROTO_CRYPT_SIZE, &ctrl);
+    memcpy(buffer + addresses, relay, ARISR_ADDRESS_SIZE);
+
+    /* =============== CRC HEADER ================= */
+    header = addresses + ARISR_ADDRESS_SIZE + ctrl2;
+    crc = ARISR_crypt_crc16_calculate(buffer, header);
+    buffer[header]     = (ARISR_UINT8)(crc >> 8);
+    buffer[header + 1] = (ARISR_UINT8)crc;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_iov_ctx(ARISR_IOVEC iov[ARISR_PROTO_IOV_MAX], ARISR_UINT32 *count, ARISR_UINT32 *length, ARISR_FRAME_SCRATCH *scratch,
+                                    ARISR_UINT8 *cipher, ARISR_UINT32 cipher_capacity, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx)
+{
+    ARISR_CRC16_CTX header_crc, data_crc;
+    ARISR_CHUNK_CTRL2 ctrl2;
+    ARISR_UINT32 size, middle = 0, tail = 0, encrypted_length = 0, n = 0;
+    ARISR_UINT16 crc;
+    ARISR_ERR err;
+
+    if (!iov || !count || !length || !scratch || !data || !ctx) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if ((err = ARISR_proto_frame_size(data, &size)) != kARISR_OK) {
+        return err;
+    }
+    *length = size;
+    *count = 0;
+
+    if (data->ctrl.destinations > 0 && !data->destinationsB) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    /* =============== DATA ================= */
+    // Encrypted into the caller's buffer with its CRC, before the header that carries its length
+    ARISR_crypt_crc16_init(&data_crc);
+    if (data->ctrl.more_header && data->ctrl2.data_length > 0) {
+        if (!data->data || !cipher) {
+            return kARISR_ERR_INVALID_ARGUMENT;
+        }
+        if ((err = ARISR_aes_data_encrypt_crc_into_ctx(ctx, data->data, data->ctrl2.data_length, cipher, cipher_capacity,
+                                                       &encrypted_length, &data_crc)) != kARISR_OK) {
+            return err;
+        }
+    }
+
+    /* =============== HEAD ================= */
+    // ID + ARIS + CTRL1 + ORIGIN + DEST A
+    memcpy(scratch->head, data->id, ARISR_PROTO_CRYPT_SIZE);
+    if ((err = ARISR_aes_aris_encrypt_ctx(ctx, scratch->head + ARISR_PROTO_ID_SIZE)) != kARISR_OK) {
+        return err;
+    }
+    ARISR_proto_ctrl_encode(scratch->head + ARISR_PROTO_CRYPT_SIZE, &data->ctrl);
+    memcpy(scratch->head + ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE, data->origin, ARISR_ADDRESS_SIZE * 2);
+
+    /* =============== MIDDLE ================= */
+    // DEST C + CTRL2, then the header CRC
+    if (data->ctrl.from) {
+        memcpy(scratch->middle, data->destinationC, ARISR_ADDRESS_SIZE);
+        middle += ARISR_ADDRESS_SIZE;
+    }
+    if (data->ctrl.more_header) {
+        ctrl2 = data->ctrl2;
+        ctrl2.data_length = encrypted_length;
+        ARISR_proto_ctrl2_encode(scratch->middle + middle, &ctrl2);
+        middle += ARISR_CTRL2_SECTION_SIZE;
+    }
+
+    // The header CRC runs over the pieces, the destination list is read where it is
+    ARISR_crypt_crc16_init(&header_crc);
+    ARISR_crypt_crc16_update(&header_crc, scratch->head, sizeof(scratch->head));
+    ARISR_crypt_crc16_update(&header_crc, (const ARISR_UINT8 *)data->destinationsB, data->ctrl.destinations * ARISR_ADDRESS_SIZE);
+    ARISR_crypt_crc16_update(&header_crc, scratch->middle, middle);
+    crc = ARISR_crypt_crc16_final(&header_crc);
+    scratch->middle[middle++] = (ARISR_UINT8)(crc >> 8);
+    scratch->middle[middle++] = (ARISR_UINT8)crc;
+
+    /* =============== TAIL ================= */
+    // CRC data + END
+    if (encrypted_length > 0) {
+        crc = ARISR_crypt_crc16_final(&data_crc);
+        scratch->tail[tail++] = (ARISR_UINT8)(crc >> 8);
+        scratch->tail[tail++] = (ARISR_UINT8)crc;
+    }
+    memcpy(scratch->tail + tail, data->id, ARISR_PROTO_ID_SIZE);
+    tail += ARISR_PROTO_ID_SIZE;
+
+    // Only the pieces present in this frame are listed
+    iov[n].base = scratch->head;
+    iov[n++].length = sizeof(scratch->head);
+    if (data->ctrl.destinations > 0) {
+        iov[n].base = (const ARISR_UINT8 *)data->destinationsB;
+        iov[n++].length = data->ctrl.destinations * ARISR_ADDRESS_SIZE;
+    }
+    iov[n].base = scratch->middle;
+    iov[n++].length = middle;
+    if (encrypted_length > 0) {
+        iov[n].base = cipher;
+        iov[n++].length = encrypted_length;
+    }
+    iov[n].base = scratch->tail;
+    iov[n++].length = tail;
+
+    *count = n;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_iov(ARISR_IOVEC iov[ARISR_PROTO_IOV_MAX], ARISR_UINT32 *count, ARISR_UINT32 *length, ARISR_FRAME_SCRATCH *scratch,
+                                ARISR_UINT8 *cipher, ARISR_UINT32 cipher_capacity, const ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_build_iov_ctx(iov, count, length, scratch, cipher, cipher_capacity, data, &ctx);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_into_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx)
+{
+    ARISR_ERR err;
+    if (!data || !buffer || !length || !ctx) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    // Pointer to save size of the buffer
+    unsigned int p;
+    ARISR_UINT32 size, encrypted_length = 0;
+    ARISR_UINT16 crc;
+    ARISR_CRC16_CTX data_crc;
+    ARISR_CHUNK_CTRL2 ctrl2;
+
+    // Exact size of the frame, known before writing anything
+    if ((err = ARISR_proto_frame_size(data, &size)) != kARISR_OK) {
+        return err;
+    }
+
+    // Assign the size to the length, so the caller knows how much is needed
+    *length = size;
+
+    if (capacity < size) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+
+    if (data->ctrl.more_header && data->ctrl2.data_length > 0 && !data->data) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    // Start writing the buffer
+    p = 0;
+
+    /* ================  ID  ================== */
+    memcpy(buffer, data->id, ARISR_PROTO_CRYPT_SIZE);
+    p += ARISR_PROTO_CRYPT_SIZE;
+
+    /* =============== ARIS ================= */
+    if ((err = ARISR_aes_aris_encrypt_ctx(ctx, buffer + ARISR_PROTO_ID_SIZE)) != kARISR_OK) {
+        return err;
+    }
+
+    /* =============== CTRL 1 ================= */
+    ARISR_proto_ctrl_encode(buffer + p, &data->ctrl);
+    p += ARISR_CTRL_SECTION_SIZE;
+
+    /* =============== ORIGIN & DESTINATION ================= */
+    memcpy(buffer + p, data->origin, ARISR_ADDRESS_SIZE * 2);
+    p += ARISR_ADDRESS_SIZE * 2;
+
+    /* =============== DESTINATIONS B ================= */
+    if (data->ctrl.destinations > 0) {
+        memcpy(buffer + p, data->destinationsB, data->ctrl.destinations * ARISR_ADDRESS_SIZE);
+        p += data->ctrl.destinations * ARISR_ADDRESS_SIZE;
+    }
+
+    /* =============== DESTINATION C ================= */
+    if (data->ctrl.from) {
+        memcpy(buffer + p, data->destinationC, ARISR_ADDRESS_SIZE);
+        p += ARISR_ADDRESS_SIZE;
+    }
+
+    /* =============== DATA ================= */
+    // Pad and encrypt the data section directly in its final place, after CTRL2 and CRC header
+    // The data CRC is taken over each ciphertext strip as it is produced
+    ARISR_crypt_crc16_init(&data_crc);
+    if (data->ctrl.more_header && data->ctrl2.data_length > 0) {
+        if ((err = ARISR_aes_data_encrypt_crc_into_ctx(ctx
+            , data->data, data->ctrl2.data_length
+            , buffer + p + ARISR_CTRL2_SECTION_SIZE + ARISR_CRC_SIZE
+            , size - p - ARISR_CTRL2_SECTION_SIZE - ARISR_CRC_SIZE, &encrypted_length, &data_crc)) != kARISR_OK) {
+
+            return err;
+        }
+    }
+
+    /* =============== CTRL 2 ================= */
+    if (data->ctrl.more_header) {
+        // Write the data length
+        ctrl2 = data->ctrl2;
+        ctrl2.data_length = encrypted_length;
+        ARISR_proto_ctrl2_encode(buffer + p, &ctrl2);
+        p += ARISR_CTRL2_SECTION_SIZE;
+    }
+
+    /* =============== CRC HEADER ================= */
+    // Calculate CRC over the entire header portion from index 0 to p-1
+    crc = ARISR_crypt_crc16_calculate(buffer, p);
+    buffer[p++] = (ARISR_UINT8)(crc >> 8) & 0xFF;
+    buffer[p++] = (ARISR_UINT8)(crc) & 0xFF;
+
+    /* =============== CRC DATA ================= */
+    if (encrypted_length > 0) {
+        // Already computed while encrypting
+        crc = ARISR_crypt_crc16_final(&data_crc);
+        p += encrypted_length;
+        buffer[p++] = (ARISR_UINT8)(crc >> 8) & 0xFF;
+        buffer[p++] = (ARISR_UINT8)(crc) & 0xFF;
+    }
+
+    /* =============== END ================= */
+    // Write the end field
+    memcpy(buffer + p, data->id, ARISR_PROTO_ID_SIZE);
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_into(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_build_into_ctx(buffer, capacity, length, data, &ctx);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_ctx(ARISR_UINT8 **buffer, ARISR_UINT32 *length, const ARISR_CHUNK *data, const ARISR_KEY_CTX *ctx)
+{
+    ARISR_ERR err;
+    ARISR_UINT32 size;
+
+    if (!data || !buffer || !length || !ctx) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if ((err = ARISR_proto_frame_size(data, &size)) != kARISR_OK) {
+        return err;
+    }
+
+    // Allocate the buffer, the frame is written directly inside it
+    *buffer = (ARISR_UINT8*)malloc(sizeof(ARISR_UINT8) * size);
+
+    // Check if the buffer was allocated
+    if (!*buffer) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if ((err = ARISR_proto_build_into_ctx(*buffer, size, length, data, ctx)) != kARISR_OK) {
+        free(*buffer);
+        *buffer = NULL;
+        return err;
+    }
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build(ARISR_UINT8 **buffer, ARISR_UINT32 *length, ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_build_ctx(buffer, length, data, &ctx);
+}
+
+// =============================================
+static ARISR_ERR ARISR_proto_view_header(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, const ARISR_UINT8 *id)
+{
+    // Reading pointer (index) for the 'data' buffer
+    unsigned int p = 0;
+    const ARISR_UINT8 *ctrl;
+    ARISR_UINT16 crc, expected_crc;
+
+    memset(view, 0, sizeof(ARISR_FRAME_VIEW));
+    view->frame = data;
+
+    /* =============== ID & ARIS ================= */
+    if (memcmp(data, id, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_ID;
+    }
+
+    if (ARISR_aes_aris_decrypt_ctx(ctx, data + ARISR_PROTO_ID_SIZE) != kARISR_OK) {
+        return kARISR_ERR_NOT_SAME_ARIS;
+    }
+    p += ARISR_PROTO_CRYPT_SIZE;
+
+    /* =============== CTRL 1 ================= */
+    ctrl = data + p;
+    p += ARISR_CTRL_SECTION_SIZE;
+
+    ARISR_proto_ctrl_decode(ctrl, &view->ctrl);
+
+    /* =============== ORIGIN & DESTINATION ================= */
+    view->origin = data + p;
+    view->destinationA = data + p + ARISR_ADDRESS_SIZE;
+    p += ARISR_ADDRESS_SIZE * 2;
+
+    /* =============== DESTINATIONS B ================= */
+    if (view->ctrl.destinations > 0) {
+        view->destinationsB = (const ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE])(data + p);
+        p += view->ctrl.destinations * ARISR_ADDRESS_SIZE;
+    }
+
+    /* =============== DESTINATION C ================= */
+    if (view->ctrl.from) {
+        view->destinationC = data + p;
+        p += ARISR_ADDRESS_SIZE;
+    }
+
+    /* ================= CTRL 2 ===================== */
+    if (view->ctrl.more_header) {
+        ctrl = data + p;
+        p += ARISR_CTRL2_SECTION_SIZE;
+        ARISR_proto_ctrl2_decode(ctrl, &view->ctrl2);
+    }
+
+    /* =============== CRC HEADER ================= */
+    expected_crc = ((ARISR_UINT16)data[p] << 8) | data[p + 1];
+    crc = ARISR_crypt_crc16_calculate(data, p);
+    if (crc != expected_crc) {
+        return kARISR_ERR_NOT_SAME_CRC_HEADER;
+    }
+
+    view->header_length = p;
+    view->data_offset = p + ARISR_CRC_SIZE;
+
+    return kARISR_OK;
+}
+
+// =============================================
+static ARISR_ERR ARISR_proto_view_payload(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *id)
+{
+    const ARISR_UINT8 *data = view->frame;
+    unsigned int p = view->data_offset;
+    ARISR_UINT16 crc, expected_crc;
+
+    /* =============== DATA ================= */
+    if (view->ctrl2.data_length > 0) {
+        expected_crc = ((ARISR_UINT16)data[p + view->ctrl2.data_length] << 8)
+                     | data[p + view->ctrl2.data_length + 1];
+
+        crc = ARISR_crypt_crc16_calculate(data + p, view->ctrl2.data_length);
+        if (crc != expected_crc) {
+            return kARISR_ERR_NOT_SAME_CRC_DATA;
+        }
+        p += view->ctrl2.data_length + ARISR_CRC_SIZE;
+    }
+
+    /* =============== END ================= */
+    if (memcmp(data + p, id, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_END;
+    }
+
+    view->length = p + ARISR_PROTO_ID_SIZE;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view_ctx(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    ARISR_ERR err;
+
+    if (!view || !data || !id || !ctx) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if ((err = ARISR_proto_view_header(view, data, ctx, id)) != kARISR_OK) {
+        return err;
+    }
+
+    return ARISR_proto_view_payload(view, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_view_ctx(view, data, &ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view_len_ctx(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    ARISR_ERR err;
+
+    if (!view || !data || !id) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    memset(view, 0, sizeof(ARISR_FRAME_VIEW));
+
+    if ((err = ARISR_proto_check_length(data, length)) != kARISR_OK) {
+        return err;
+    }
+
+    return ARISR_proto_view_ctx(view, data, ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view_len(ARISR_FRAME_VIEW *view, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_view_len_ctx(view, data, length, &ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view_decrypt(const ARISR_FRAME_VIEW *view, const ARISR_AES128_KEY key, ARISR_UINT8 **output, ARISR_UINT32 *length)
+{
+    if (!view || !view->frame || !output || !length) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    *output = NULL;
+    *length = 0;
+
+    // Nothing to decrypt
+    if (view->ctrl2.data_length == 0) {
+        return kARISR_OK;
+    }
+
+    return ARISR_aes_data_decrypt(
+        (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
+        , view->frame + view->data_offset, view->ctrl2.data_length, output, length);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_view_decrypt_ctx(const ARISR_FRAME_VIEW *view, const ARISR_KEY_CTX *ctx, ARISR_UINT8 **output, ARISR_UINT32 *length)
+{
+    if (!view || !view->frame || !ctx || !output || !length) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    *output = NULL;
+    *length = 0;
 
-    // Extract required bits from CTRL1
-    buffer->ctrl.version        = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_VERSION_MASK, ARISR_CTRL_VERSION_SHIFT);
-    buffer->ctrl.destinations   = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT);
-    buffer->ctrl.from           = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT);
-    buffer->ctrl.option         = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_OPTION_MASK, ARISR_CTRL_OPTION_SHIFT);
-    buffer->ctrl.sequence       = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_SEQUENCE_MASK, ARISR_CTRL_SEQUENCE_SHIFT);
-    buffer->ctrl.retry          = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_RETRY_MASK, ARISR_CTRL_RETRY_SHIFT);
-    buffer->ctrl.more_data      = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_MD_MASK, ARISR_CTRL_MD_SHIFT);
-    buffer->ctrl.identifier     = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_ID_MASK, ARISR_CTRL_ID_SHIFT);
-    buffer->ctrl.more_header    = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT);
+    // Nothing to decrypt
+    if (view->ctrl2.data_length == 0) {
+        return kARISR_OK;
+    }
 
-    /* =============== ORIGIN & DESTINATION ================= */
-    // 3- Copy origin (6 bytes) and destinationA (6 bytes)
-    memcpy(buffer->origin, data + p, ARISR_ADDRESS_SIZE * 2);
-    p += ARISR_ADDRESS_SIZE * 2;
+    return ARISR_aes_data_decrypt_ctx(ctx, view->frame + view->data_offset, view->ctrl2.data_length, output, length);
+}
 
-    /* =============== DESTINATIONS B ================= */
-    // 4- Copy the next 'destinations' addresses (each 6 bytes)
-    if (buffer->ctrl.destinations > 0) {
-        buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE])
-                                 malloc(buffer->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
-        if (!buffer->destinationsB) {
-            ARISR_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
-        }
-        memcpy(buffer->destinationsB, data + p, buffer->ctrl.destinations * ARISR_ADDRESS_SIZE);
-        p += buffer->ctrl.destinations * ARISR_ADDRESS_SIZE;
+// =============================================
+ARISR_ERR ARISR_proto_view_decrypt_into(const ARISR_FRAME_VIEW *view, const ARISR_AES128_KEY key, ARISR_UINT8 *output, ARISR_UINT32 capacity, ARISR_UINT32 *length)
+{
+    if (!view || !view->frame || !output || !length) {
+        return kARISR_ERR_GENERIC;
     }
 
-    /* =============== DESTINATION C ================= */
-    // 5- If 'from_relay' is set, copy the 'destinationC' field (6 bytes)
-    memset(buffer->destinationC, '\0', ARISR_ADDRESS_SIZE);
-    if (buffer->ctrl.from) {
-        memcpy(buffer->destinationC, data + p, ARISR_ADDRESS_SIZE);
-        p += ARISR_ADDRESS_SIZE;
-    }
+    *length = 0;
 
-    /* ================= CTRL 2 ===================== */
-    // 6- If 'more_headers' is set, we allocate and copy CTRL2
-    if (buffer->ctrl.more_header) {
-        memcpy(ctrl, data + p, ARISR_CTRL_SECTION_SIZE);
-        p += ARISR_CTRL2_SECTION_SIZE;
-        buffer->ctrl2.data_length = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL2_DATA_LENGTH_MASK, ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT;
-        buffer->ctrl2.feature     = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL2_FEATURE_MASK, ARISR_CTRL2_FEATURE_SHIFT);
-        buffer->ctrl2.neg_answer  = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL2_NEG_ANSWER_MASK, ARISR_CTRL2_NEG_ANSWER_SHIFT);
-        buffer->ctrl2.freq_switch = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL2_FREQ_SWITCH_MASK, ARISR_CTRL2_FREQ_SWITCH_SHIFT);
-    } else {
-        memset(&buffer->ctrl2, '\0', ARISR_CTRL2_SECTION_SIZE);
+    // Nothing to decrypt
+    if (view->ctrl2.data_length == 0) {
+        return kARISR_OK;
     }
 
-    /* =============== CRC HEADER ================= */
-    // 7- Copy the 2-byte CRC for the header
-    memcpy(buffer->crc_header, data + p, ARISR_CRC_SIZE);
-
-    // Convert 'crc_header' (2 bytes) into an ARISR_UINT16 for comparison
-    ARISR_UINT16 expected_crc_header = ((ARISR_UINT16)buffer->crc_header[0] << 8) 
-                                     | buffer->crc_header[1];
+    return ARISR_aes_data_decrypt_into(
+        (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
+        , view->frame + view->data_offset, view->ctrl2.data_length, output, capacity, length);
+}
 
-    // Calculate CRC over the entire header portion from index 0 to p-1
-    // 'p' currently points at the start of the CRC header, so the header size is 'p'.
-    crc = ARISR_crypt_crc16_calculate((const ARISR_UINT8*)data, p);
-    if (crc != expected_crc_header) {
-        ARISR_CLEAN_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_HEADER);
+// =============================================
+ARISR_ERR ARISR_proto_view_decrypt_into_ctx(const ARISR_FRAME_VIEW *view, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *output, ARISR_UINT32 capacity, ARISR_UINT32 *length)
+{
+    if (!view || !view->frame || !ctx || !output || !length) {
+        return kARISR_ERR_GENERIC;
     }
-    p += ARISR_CRC_SIZE;
 
-    /* =============== DATA ================= */
-    // 8- If 'more_headers' is set, we parse the data section and decrypt it with its CRC
-    if (buffer->ctrl.more_header && buffer->ctrl2.data_length > 0) {
-        // Copy the 2-byte CRC for the data
-        memcpy(buffer->crc_data, data + p + buffer->ctrl2.data_length, ARISR_CRC_SIZE);
+    *length = 0;
 
-        // Convert 'crc_data' (2 bytes) into an ARISR_UINT16 for comparison
-        ARISR_UINT16 expected_crc_data = ((ARISR_UINT16)buffer->crc_data[0] << 8) 
-                                       | buffer->crc_data[1];
+    // Nothing to decrypt
+    if (view->ctrl2.data_length == 0) {
+        return kARISR_OK;
+    }
 
-        // Calculate CRC over the entire data portion from index 0 to p-1
-        // 'p' currently points at the start of the CRC data, so the data size is 'p'.
-        crc = ARISR_crypt_crc16_calculate((const ARISR_UINT8*)data + p, buffer->ctrl2.data_length);
-        if (crc != expected_crc_data) {
-            ARISR_CLEAN_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_DATA);
-        }
+    return ARISR_aes_data_decrypt_into_ctx(ctx, view->frame + view->data_offset, view->ctrl2.data_length, output, capacity, length);
+}
 
-        // Data
-        ARISR_UINT8 *decrypted_data;
-        ARISR_UINT32 decrypted_length;
-        if ((err = ARISR_aes_data_decrypt(
-            (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
-            , data + p, buffer->ctrl2.data_length, &decrypted_data, &decrypted_length)) != kARISR_OK) {
+/* ===== FIXED-CAPACITY CHUNK ===== */
 
-            ARISR_CLEAN_AND_RETURN(err);
-        }
+// =============================================
+static ARISR_ERR ARISR_proto_static_from_view(ARISR_CHUNK_STATIC *buffer, const ARISR_FRAME_VIEW *view, const ARISR_KEY_CTX *ctx)
+{
+    const ARISR_UINT8 *data = view->frame;
+    ARISR_UINT32 data_length = 0;
+    ARISR_ERR err;
 
-        // Copy data to buffer
-        buffer->data = decrypted_data;
+#if ARISR_STATIC_MAX_DESTINATIONS < ARISR_PROTO_MAX_DESTINATIONS
+    if (view->ctrl.destinations > ARISR_STATIC_MAX_DESTINATIONS) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+#endif
 
-        // Move the pointer to the next section after the data
-        p += buffer->ctrl2.data_length + ARISR_CRC_SIZE;
+    // Fixed fields, straight from the validated frame
+    memcpy(buffer->id, data, ARISR_PROTO_CRYPT_SIZE);
+    buffer->ctrl = view->ctrl;
+    memcpy(buffer->origin, view->origin, ARISR_ADDRESS_SIZE);
+    memcpy(buffer->destinationA, view->destinationA, ARISR_ADDRESS_SIZE);
 
-        // Update real data length decrypted
-        buffer->ctrl2.data_length = decrypted_length;
+    if (view->destinationsB) {
+        memcpy(buffer->destinationsB, view->destinationsB, view->ctrl.destinations * ARISR_ADDRESS_SIZE);
     }
 
-    /* =============== END ================= */
-    // 9- Finally, copy the 4-byte 'end' field
-    memcpy(buffer->end, data + p, ARISR_PROTO_ID_SIZE);
+    if (view->destinationC) {
+        memcpy(buffer->destinationC, view->destinationC, ARISR_ADDRESS_SIZE);
+    } else {
+        memset(buffer->destinationC, 0, ARISR_ADDRESS_SIZE);
+    }
 
-    // Check if 'end' is the same as the provided 'id'
-    if (memcmp(buffer->end, id, ARISR_PROTO_ID_SIZE) != 0) {
-        return kARISR_ERR_NOT_SAME_END;
+    buffer->ctrl2 = view->ctrl2;
+    memcpy(buffer->crc_header, data + view->header_length, ARISR_CRC_SIZE);
+    memset(buffer->crc_data, 0, ARISR_CRC_SIZE);
+
+    // Data, decrypted directly into the inline array
+    if (view->ctrl2.data_length > 0) {
+        memcpy(buffer->crc_data, data + view->data_offset + view->ctrl2.data_length, ARISR_CRC_SIZE);
+        if ((err = ARISR_aes_data_decrypt_into_ctx(ctx, data + view->data_offset, view->ctrl2.data_length
+            , buffer->data, ARISR_STATIC_MAX_DATA_LENGTH, &data_length)) != kARISR_OK) {
+            return err;
+        }
     }
+    buffer->ctrl2.data_length = data_length;
+
+    memcpy(buffer->end, data + view->length - ARISR_PROTO_ID_SIZE, ARISR_PROTO_ID_SIZE);
 
     return kARISR_OK;
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_build(ARISR_UINT8 **buffer, ARISR_UINT32 *length, ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+ARISR_ERR ARISR_proto_parse_static_ctx(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
 {
+    ARISR_FRAME_VIEW view;
     ARISR_ERR err;
-    if (!data || !buffer || !length) {
+
+    if (!buffer || !data || !ctx || !id) {
         return kARISR_ERR_GENERIC;
     }
 
-    // Pointer to save size of the buffer
-    unsigned int p, size;
-    ARISR_UINT16 crc;
-    ARISR_UINT32 encrypted_length = 0;
-    ARISR_UINT8 *encrypted_data = NULL, ctrl[4];
-
-    // Minimun size of the buffer
-    size = ARISR_PROTO_ID_SIZE + ARISR_PROTO_ARIS_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2 + ARISR_CRC_SIZE + ARISR_PROTO_ID_SIZE;
-    // Calculate the destinations
-    if (data->ctrl.destinations > 0) {
-        size += data->ctrl.destinations * ARISR_ADDRESS_SIZE;
+    // Every CRC and the end mark are checked by the view before anything is copied
+    if ((err = ARISR_proto_view_ctx(&view, data, ctx, id)) != kARISR_OK) {
+        return err;
     }
 
-    // Get from
-    if (data->ctrl.from) {
-        size += ARISR_ADDRESS_SIZE;
-    }
+    return ARISR_proto_static_from_view(buffer, &view, ctx);
+}
 
-    // Get more headers
-    if (data->ctrl.more_header) {
-        size += ARISR_CTRL2_SECTION_SIZE;
+// =============================================
+ARISR_ERR ARISR_proto_parse_static(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
 
-        /* =============== DATA ================= */// -----> Calculate first the apply to ctrl2
-        // Calculate the data length
-        if (data->ctrl2.data_length > 0) {
-            // Encrypt the data section using AES key
-            if ((err = ARISR_aes_data_encrypt(
-                (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
-                , data->data, data->ctrl2.data_length, &encrypted_data, &encrypted_length)) != kARISR_OK) {
-                
-                return err;
-            }
+    ARISR_aes_key_ctx_lazy(&ctx, key);
 
-            size += encrypted_length + ARISR_CRC_SIZE;
-        }
-    }
+    return ARISR_proto_parse_static_ctx(buffer, data, &ctx, id);
+}
 
-    // Allocate the buffer
-    *buffer = (ARISR_UINT8*)malloc(sizeof(ARISR_UINT8) * size);
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_static_ctx(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    ARISR_FRAME_VIEW view;
+    ARISR_ERR err;
 
-    // Check if the buffer was allocated
-    if (!*buffer) {
+    if (!buffer || !data || !ctx || !id) {
         return kARISR_ERR_GENERIC;
     }
 
-    memset(*buffer, '\0', size);
+    if ((err = ARISR_proto_view_len_ctx(&view, data, length, ctx, id)) != kARISR_OK) {
+        return err;
+    }
 
-    // Assign the size to the length
-    *length = size;
+    return ARISR_proto_static_from_view(buffer, &view, ctx);
+}
 
-    // Start writing the buffer
-    p = 0;
+// =============================================
+ARISR_ERR ARISR_proto_parse_len_static(ARISR_CHUNK_STATIC *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    ARISR_KEY_CTX ctx;
 
-    /* ================  ID  ================== */
-    memcpy(*buffer, data, ARISR_PROTO_CRYPT_SIZE);
-    p += ARISR_PROTO_CRYPT_SIZE;
+    ARISR_aes_key_ctx_lazy(&ctx, key);
 
-    /* =============== ARIS ================= */
-    if ((err = ARISR_aes_aris_encrypt(key, *buffer + ARISR_PROTO_ID_SIZE)) != kARISR_OK) {
-        free(*buffer);
-        return err;
+    return ARISR_proto_parse_len_static_ctx(buffer, data, length, &ctx, id);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_static_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK_STATIC *data, const ARISR_KEY_CTX *ctx)
+{
+    ARISR_CHUNK chunk;
+
+    if (!buffer || !length || !data || !ctx) {
+        return kARISR_ERR_GENERIC;
     }
 
+#if ARISR_STATIC_MAX_DESTINATIONS < ARISR_PROTO_MAX_DESTINATIONS
+    if (data->ctrl.destinations > ARISR_STATIC_MAX_DESTINATIONS) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+#endif
+    if (data->ctrl2.data_length > ARISR_STATIC_MAX_DATA_LENGTH) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
 
-    /* =============== CTRL 1 ================= */
-    memset(ctrl, '\0', ARISR_CTRL_SECTION_SIZE);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.version, ARISR_CTRL_VERSION_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.destinations, ARISR_CTRL_DESTS_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.from, ARISR_CTRL_FROM_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.option, ARISR_CTRL_OPTION_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.sequence, ARISR_CTRL_SEQUENCE_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.retry, ARISR_CTRL_RETRY_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.more_data, ARISR_CTRL_MD_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.identifier, ARISR_CTRL_ID_SHIFT);
-    ARISR_proto_ctrl_setField(ctrl, data->ctrl.more_header, ARISR_CTRL_MH_SHIFT);
-
-    memcpy(*buffer + p, ctrl, ARISR_CTRL_SECTION_SIZE);
-    p += ARISR_CTRL_SECTION_SIZE;
+    // Shallow ARISR_CHUNK pointing at the inline arrays, nothing is copied but the fixed fields
+    memset(&chunk, 0, sizeof(ARISR_CHUNK));
+    memcpy(chunk.id, data->id, ARISR_PROTO_ID_SIZE);
+    memcpy(chunk.aris, data->aris, ARISR_PROTO_ARIS_SIZE);
+    chunk.ctrl = data->ctrl;
+    memcpy(chunk.origin, data->origin, ARISR_ADDRESS_SIZE);
+    memcpy(chunk.destinationA, data->destinationA, ARISR_ADDRESS_SIZE);
+    chunk.destinationsB = (ARISR_UINT48 *)data->destinationsB;
+    memcpy(chunk.destinationC, data->destinationC, ARISR_ADDRESS_SIZE);
+    chunk.ctrl2 = data->ctrl2;
+    chunk.data = (ARISR_UINT8 *)data->data;
+
+    return ARISR_proto_build_into_ctx(buffer, capacity, length, &chunk, ctx);
+}
 
-    /* =============== ORIGIN & DESTINATION ================= */
-    memcpy(*buffer + p, data->origin, ARISR_ADDRESS_SIZE * 2);
-    p += ARISR_ADDRESS_SIZE * 2;
+// =============================================
+ARISR_ERR ARISR_proto_build_static(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, ARISR_UINT32 *length, const ARISR_CHUNK_STATIC *data, const ARISR_AES128_KEY key)
+{
+    ARISR_KEY_CTX ctx;
 
-    /* =============== DESTINATIONS B ================= */
-    if (data->ctrl.destinations > 0) {
-        size = data->ctrl.destinations * ARISR_ADDRESS_SIZE;
-        memcpy(*buffer + p, data->destinationsB, size);
-        p += size;
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_build_static_ctx(buffer, capacity, length, data, &ctx);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_build_fragments_ctx(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, const ARISR_CHUNK *header,
+                                          const ARISR_UINT8 *payload, ARISR_UINT32 payload_length, ARISR_UINT32 fragment_size,
+                                          ARISR_UINT32 offsets[], ARISR_UINT32 max_fragments, ARISR_UINT32 *count, const ARISR_KEY_CTX *ctx)
+{
+    ARISR_CHUNK chunk;
+    ARISR_UINT32 fragments, k, offset, size, last_size, written;
+    ARISR_ERR err;
+
+    if (!buffer || !header || (!payload && payload_length > 0) || !offsets || !count || !ctx) {
+        return kARISR_ERR_GENERIC;
     }
 
-    /* =============== DESTINATION C ================= */
-    if (data->ctrl.from) {
-        memcpy(*buffer + p, data->destinationC, ARISR_ADDRESS_SIZE);
-        p += ARISR_ADDRESS_SIZE;
+    if (fragment_size == 0 || fragment_size > ARISR_PROTO_MAX_FRAGMENT_SIZE) {
+        return kARISR_ERR_INVALID_ARGUMENT;
     }
 
-    /* =============== CTRL 2 ================= */
-    if (data->ctrl.more_header) {
-        // Write the data length
-        memset(ctrl, '\0', ARISR_CTRL2_SECTION_SIZE);
-        ARISR_proto_ctrl_setField(ctrl, encrypted_length / ARISR_DATA_MULT, ARISR_CTRL2_DATA_LENGTH_SHIFT);
-        ARISR_proto_ctrl_setField(ctrl, data->ctrl2.feature, ARISR_CTRL2_FEATURE_SHIFT);
-        ARISR_proto_ctrl_setField(ctrl, data->ctrl2.neg_answer, ARISR_CTRL2_NEG_ANSWER_SHIFT);
-        ARISR_proto_ctrl_setField(ctrl, data->ctrl2.freq_switch, ARISR_CTRL2_FREQ_SWITCH_SHIFT);
+    // An empty message is still sent, as one frame without data
+    fragments = payload_length > 0 ? (payload_length - 1) / fragment_size + 1 : 1;
+    *count = fragments;
 
-        memcpy(*buffer + p, ctrl, ARISR_CTRL2_SECTION_SIZE);
-        p += ARISR_CTRL2_SECTION_SIZE;
+    if (fragments > max_fragments || fragments > ARISR_PROTO_MAX_FRAGMENTS) {
+        return kARISR_ERR_INVALID_ARGUMENT;
     }
 
-    /* =============== CRC HEADER ================= */
-    // Calculate CRC over the entire header portion from index 0 to p-1
-    crc = ARISR_crypt_crc16_calculate(*buffer, p);
-    (*buffer)[p++] = (ARISR_UINT8)(crc >> 8) & 0xFF;
-    (*buffer)[p++] = (ARISR_UINT8)(crc) & 0xFF;
+    // Shallow copy of the template, only the per-fragment fields change
+    chunk = *header;
+    chunk.ctrl.more_header = 1;
 
-    /* =============== DATA ================= */
-    memcpy(*buffer + p, encrypted_data, encrypted_length);
-    p += encrypted_length;
+    // Every fragment but the last one has the same size, so the offsets are known before encrypting
+    chunk.ctrl2.data_length = fragments > 1 ? fragment_size : payload_length;
+    err = ARISR_proto_frame_size(&chunk, &size);
+    if (err != kARISR_OK) {
+        return err;
+    }
 
-    /* =============== CRC DATA ================= */
-    if (data->ctrl.more_header && data->ctrl2.data_length > 0) {
-        // Calculate CRC over the entire data portion from index 0 to p-1
-        crc = ARISR_crypt_crc16_calculate(encrypted_data, encrypted_length);
-        (*buffer)[p++] = (ARISR_UINT8)(crc >> 8) & 0xFF;
-        (*buffer)[p++] = (ARISR_UINT8)(crc) & 0xFF;
+    chunk.ctrl2.data_length = payload_length - (fragments - 1) * fragment_size;
+    err = ARISR_proto_frame_size(&chunk, &last_size);
+    if (err != kARISR_OK) {
+        return err;
     }
 
-    /* =============== END ================= */
-    // Write the end field
-    memcpy(*buffer + p, data->id, ARISR_PROTO_ID_SIZE);
+    offset = 0;
+    for (k = 0; k < fragments; k++) {
+        offsets[k] = offset;
+        offset += k + 1 < fragments ? size : last_size;
+    }
+    offsets[fragments] = offset;
 
-    // Free the encrypted data
-    free(encrypted_data);
+    if (offset > capacity) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+
+    for (k = 0; k < fragments; k++) {
+        chunk.ctrl.sequence = (ARISR_UINT8)k;
+        chunk.ctrl.more_data = k + 1 < fragments;
+        chunk.ctrl2.data_length = k + 1 < fragments ? fragment_size : payload_length - k * fragment_size;
+        chunk.data = (ARISR_UINT8 *)(payload ? payload + k * fragment_size : NULL);
+
+        err = ARISR_proto_build_into_ctx(buffer + offsets[k], offsets[k + 1] - offsets[k], &written, &chunk, ctx);
+        if (err != kARISR_OK) {
+            return err;
+        }
+    }
 
     return kARISR_OK;
 }
 
+// =============================================
+ARISR_ERR ARISR_proto_build_fragments(ARISR_UINT8 *buffer, ARISR_UINT32 capacity, const ARISR_CHUNK *header,
+                                      const ARISR_UINT8 *payload, ARISR_UINT32 payload_length, ARISR_UINT32 fragment_size,
+                                      ARISR_UINT32 offsets[], ARISR_UINT32 max_fragments, ARISR_UINT32 *count, const ARISR_AES128_KEY key)
+{
+    ARISR_KEY_CTX ctx;
+
+    ARISR_aes_key_ctx_lazy(&ctx, key);
+
+    return ARISR_proto_build_fragments_ctx(buffer, capacity, header, payload, payload_length, fragment_size,
+                                           offsets, max_fragments, count, &ctx);
+}
+
 /**
  * @brief Those functions are used step by step to pack, send, receive and unpack the data.
  * 
@@ -456,9 +1322,9 @@ ARISR_ERR ARISR_proto_build(ARISR_UINT8 **buffer, ARISR_UINT32 *length, ARISR_CH
 #if defined(ARISR_PROTO_PARTIAL_FUNCTIONS)
 
 // =============================================
-ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+ARISR_ERR ARISR_proto_recv_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator)
 {
-    if (!buffer || !data) {
+    if (!buffer || !data || !allocator) {
         return kARISR_ERR_GENERIC;
     }
 
@@ -466,7 +1332,8 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
     memset(buffer, 0, sizeof(ARISR_CHUNK_RAW));
 
     unsigned int p = 0;
-    ARISR_UINT8 destinations, from_relay, more_headers, data_length;
+    ARISR_UINT8 destinations, from_relay, more_headers;
+    ARISR_UINT32 data_length;
     ARISR_UINT16 crc;
 
     memcpy(buffer->id, data, ARISR_PROTO_CRYPT_SIZE);
@@ -492,27 +1359,27 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
     p += ARISR_ADDRESS_SIZE * 2;
 
     if (destinations > 0) {
-        buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE]) malloc(destinations * ARISR_ADDRESS_SIZE);
+        buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE]) ARISR_ALLOC(allocator, destinations * ARISR_ADDRESS_SIZE);
         if (!buffer->destinationsB) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->destinationsB, data + p, destinations * ARISR_ADDRESS_SIZE);
         p += destinations * ARISR_ADDRESS_SIZE;
     }
 
     if (from_relay) {
-        buffer->destinationC = (ARISR_UINT8*)malloc(ARISR_ADDRESS_SIZE);
+        buffer->destinationC = (ARISR_UINT8*)ARISR_ALLOC(allocator, ARISR_ADDRESS_SIZE);
         if (!buffer->destinationC) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->destinationC, data + p, ARISR_ADDRESS_SIZE);
         p += ARISR_ADDRESS_SIZE;
     }
 
     if (more_headers) {
-        buffer->ctrl2 = (ARISR_UINT8*)malloc(ARISR_CTRL2_SECTION_SIZE);
+        buffer->ctrl2 = (ARISR_UINT8*)ARISR_ALLOC(allocator, ARISR_CTRL2_SECTION_SIZE);
         if (!buffer->ctrl2) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->ctrl2, data + p, ARISR_CTRL2_SECTION_SIZE);
         p += ARISR_CTRL2_SECTION_SIZE;
@@ -526,7 +1393,7 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
 
     crc = ARISR_crypt_crc16_calculate((const ARISR_UINT8*)data, p);
     if (crc != expected_crc_header) {
-        ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_HEADER);
+        ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_HEADER);
     }
     p += ARISR_CRC_SIZE;
 
@@ -535,9 +1402,9 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
         data_length *= ARISR_DATA_MULT;
 
         if (data_length > 0) {
-            buffer->data = (ARISR_UINT8*)malloc(data_length);
+            buffer->data = (ARISR_UINT8*)ARISR_ALLOC(allocator, data_length);
             if (!buffer->data) {
-                ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+                ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
             }
             memcpy(buffer->data, data + p, data_length);
             p += data_length;
@@ -547,7 +1414,7 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
 
             crc = ARISR_crypt_crc16_calculate(buffer->data, data_length);
             if (crc != expected_crc_data) {
-                ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_DATA);
+                ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_NOT_SAME_CRC_DATA);
             }
             p += ARISR_CRC_SIZE;
         }
@@ -556,14 +1423,20 @@ ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, con
     memcpy(buffer->end, data + p, ARISR_PROTO_ID_SIZE);
 
     if (memcmp(buffer->end, id, ARISR_PROTO_ID_SIZE) != 0) {
-        ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_NOT_SAME_END);
+        ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_NOT_SAME_END);
     }
 
     return kARISR_OK;
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const ARISR_AES128_KEY key)
+ARISR_ERR ARISR_proto_recv(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    return ARISR_proto_recv_alloc(buffer, data, key, id, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_recv_len_alloc(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id, const ARISR_ALLOCATOR *allocator)
 {
     ARISR_ERR err;
 
@@ -571,6 +1444,31 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
         return kARISR_ERR_GENERIC;
     }
 
+    memset(buffer, 0, sizeof(ARISR_CHUNK_RAW));
+
+    // Reject short or oversized frames before any CRC, copy or allocation
+    if ((err = ARISR_proto_check_length(data, length)) != kARISR_OK) {
+        return err;
+    }
+
+    return ARISR_proto_recv_alloc(buffer, data, key, id, allocator);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_recv_len(ARISR_CHUNK_RAW *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length, const ARISR_AES128_KEY key, ARISR_UINT8 *id)
+{
+    return ARISR_proto_recv_len_alloc(buffer, data, length, key, id, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_unpack_alloc(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const ARISR_AES128_KEY key, const ARISR_ALLOCATOR *allocator)
+{
+    ARISR_ERR err;
+
+    if (!buffer || !data || !allocator) {
+        return kARISR_ERR_GENERIC;
+    }
+
     // Control check previous to unpacking
     // ID
     // ARIS
@@ -584,15 +1482,7 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
     memcpy(buffer->aris, data->aris, ARISR_PROTO_ARIS_SIZE);
 
     // Create struct ARISR_CTRL_CHUNK and copy the control section
-    buffer->ctrl.version = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_VERSION_MASK, ARISR_CTRL_VERSION_SHIFT);
-    buffer->ctrl.destinations = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT);
-    buffer->ctrl.option = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_OPTION_MASK, ARISR_CTRL_OPTION_SHIFT);
-    buffer->ctrl.from = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT);
-    buffer->ctrl.sequence = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_SEQUENCE_MASK, ARISR_CTRL_SEQUENCE_SHIFT);
-    buffer->ctrl.retry = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_RETRY_MASK, ARISR_CTRL_RETRY_SHIFT);
-    buffer->ctrl.more_data = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_MD_MASK, ARISR_CTRL_MD_SHIFT);
-    buffer->ctrl.identifier = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_ID_MASK, ARISR_CTRL_ID_SHIFT);
-    buffer->ctrl.more_header = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT);
+    ARISR_proto_ctrl_decode(data->ctrl, &buffer->ctrl);
 
     // Copy the origin and destinationA fields
     memcpy(buffer->origin, data->origin, ARISR_ADDRESS_SIZE);
@@ -602,9 +1492,9 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
     if (buffer->ctrl.destinations > 0 && data->destinationsB) {
 
         buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE])
-                                 malloc(buffer->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
+                                 ARISR_ALLOC(allocator, buffer->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
         if (!buffer->destinationsB) {
-            ARISR_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->destinationsB, data->destinationsB, buffer->ctrl.destinations * ARISR_ADDRESS_SIZE);
     }
@@ -617,10 +1507,7 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
     // Copy the control section 2 if allocated
     if (buffer->ctrl.more_header && data->ctrl2) {
         // Real data length is 'data_length' as n * ARISR_DATA_MULT Bytes
-        buffer->ctrl2.data_length = ARISR_proto_ctrl_getField(data->ctrl2, ARISR_CTRL2_DATA_LENGTH_MASK, ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT;
-        buffer->ctrl2.feature = ARISR_proto_ctrl_getField(data->ctrl2, ARISR_CTRL2_FEATURE_MASK, ARISR_CTRL2_FEATURE_SHIFT);
-        buffer->ctrl2.neg_answer = ARISR_proto_ctrl_getField(data->ctrl2, ARISR_CTRL2_NEG_ANSWER_MASK, ARISR_CTRL2_NEG_ANSWER_SHIFT);
-        buffer->ctrl2.freq_switch = ARISR_proto_ctrl_getField(data->ctrl2, ARISR_CTRL2_FREQ_SWITCH_MASK, ARISR_CTRL2_FREQ_SWITCH_SHIFT);
+        ARISR_proto_ctrl2_decode(data->ctrl2, &buffer->ctrl2);
     }
 
     // Copy the CRC header
@@ -631,19 +1518,20 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
         memcpy(buffer->crc_data, data->crc_data, ARISR_CRC_SIZE);
         
         // Data
-        ARISR_UINT8 *decrypted_data;
         ARISR_UINT32 decrypted_length;
+        buffer->data = (ARISR_UINT8*)ARISR_ALLOC(allocator, buffer->ctrl2.data_length);
+        if (!buffer->data) {
+            ARISR_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
+        }
+
         // Decrypt the data section using AES key
-        if ((err = ARISR_aes_data_decrypt(
+        if ((err = ARISR_aes_data_decrypt_into(
             (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
-            , data->data, buffer->ctrl2.data_length, &decrypted_data, &decrypted_length)) != kARISR_OK) {
+            , data->data, buffer->ctrl2.data_length, buffer->data, buffer->ctrl2.data_length, &decrypted_length)) != kARISR_OK) {
 
-            ARISR_CLEAN_AND_RETURN(err);
+            ARISR_CLEAN_ALLOC_AND_RETURN(err);
         }
 
-        // Copy the decrypted data
-        free(buffer->data);
-        buffer->data = decrypted_data;
         buffer->ctrl2.data_length = decrypted_length;
     }
 
@@ -654,11 +1542,17 @@ ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const A
 }
 
 // =============================================
-ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+ARISR_ERR ARISR_proto_unpack(ARISR_CHUNK *buffer, ARISR_CHUNK_RAW *data, const ARISR_AES128_KEY key)
+{
+    return ARISR_proto_unpack_alloc(buffer, data, key, &ARISR_DEFAULT_ALLOCATOR);
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_pack_alloc(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARISR_AES128_KEY key, const ARISR_ALLOCATOR *allocator)
 {
     ARISR_ERR err;
 
-    if (!buffer || !data) {
+    if (!buffer || !data || !allocator) {
         return kARISR_ERR_GENERIC;
     }
 
@@ -684,24 +1578,8 @@ ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARI
         return kARISR_ERR_NULL_DESTINATION;
     }
 
-    // Version
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.version, ARISR_CTRL_VERSION_SHIFT);
-    // Destinations
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.destinations, ARISR_CTRL_DESTS_SHIFT);
-    // Option
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.option, ARISR_CTRL_OPTION_SHIFT);
-    // From
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.from, ARISR_CTRL_FROM_SHIFT);
-    // Sequence
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.sequence, ARISR_CTRL_SEQUENCE_SHIFT);
-    // Retry
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.retry, ARISR_CTRL_RETRY_SHIFT);
-    // More data
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.more_data, ARISR_CTRL_MD_SHIFT);
-    // Identifier
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.identifier, ARISR_CTRL_ID_SHIFT);
-    // More header
-    ARISR_proto_ctrl_setField(buffer->ctrl, data->ctrl.more_header, ARISR_CTRL_MH_SHIFT);
+    // Version, destinations, option, from, sequence, retry, more data, identifier and more header
+    ARISR_proto_ctrl_encode(buffer->ctrl, &data->ctrl);
 
     // Copy the origin and destinationA fields
     memcpy(buffer->origin, data->origin, ARISR_ADDRESS_SIZE);
@@ -710,18 +1588,18 @@ ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARI
     // Copy the destinationsB array if allocated
     if (data->ctrl.destinations > 0) {
         buffer->destinationsB = (ARISR_UINT8 (*)[ARISR_ADDRESS_SIZE])
-                                malloc(data->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
+                                ARISR_ALLOC(allocator, data->ctrl.destinations * (sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE));
         if (!buffer->destinationsB) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->destinationsB, data->destinationsB, data->ctrl.destinations * ARISR_ADDRESS_SIZE);
     }
 
     // Copy the destinationC field if allocated
     if (data->ctrl.from) {
-        buffer->destinationC = (ARISR_UINT8*)malloc(sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE);
+        buffer->destinationC = (ARISR_UINT8*)ARISR_ALLOC(allocator, sizeof(ARISR_UINT8) * ARISR_ADDRESS_SIZE);
         if (!buffer->destinationC) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
         memcpy(buffer->destinationC, data->destinationC, ARISR_ADDRESS_SIZE);
     }
@@ -729,33 +1607,37 @@ ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARI
     // Copy ctrl2 if allocated
     if (data->ctrl.more_header) {
         ARISR_UINT32 encrypted_length = 0;
+        ARISR_CHUNK_CTRL2 ctrl2;
         // Check if data is set
         if (data->ctrl2.data_length > 0 && data->data) {
-            // Prepare first data
-            ARISR_UINT8 *encrypted_data;
+            // PKCS#7 always adds between 1 and a full block of padding
+            ARISR_UINT32 padded_length = data->ctrl2.data_length + (ARISR_AES128_BLOCK_SIZE - (data->ctrl2.data_length % ARISR_AES128_BLOCK_SIZE));
+            if (padded_length < data->ctrl2.data_length) {
+                ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_BUFFER_OVERFLOW);
+            }
+
+            buffer->data = (ARISR_UINT8*)ARISR_ALLOC(allocator, padded_length);
+            if (!buffer->data) {
+                ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
+            }
+
             // Encrypt the data section using AES key
-            if ((err = ARISR_aes_data_encrypt(
+            if ((err = ARISR_aes_data_encrypt_into(
                 (!ARISR_AES_IS_ZERO_KEY(key)) ? key : ARISR_DEFAULT_NULL_KEY
-                , data->data, data->ctrl2.data_length, &encrypted_data, &encrypted_length)) != kARISR_OK) {
+                , data->data, data->ctrl2.data_length, buffer->data, padded_length, &encrypted_length)) != kARISR_OK) {
 
-                ARISR_RAW_CLEAN_AND_RETURN(err);
+                ARISR_RAW_CLEAN_ALLOC_AND_RETURN(err);
             }
-
-            // Copy the encrypted data
-            free(buffer->data);
-            buffer->data = encrypted_data;
         }
 
         // Arm the control section 2
-        buffer->ctrl2 = (ARISR_UINT8*)malloc(sizeof(ARISR_UINT8) * ARISR_CTRL2_SECTION_SIZE);
+        buffer->ctrl2 = (ARISR_UINT8*)ARISR_ALLOC(allocator, sizeof(ARISR_UINT8) * ARISR_CTRL2_SECTION_SIZE);
         if (!buffer->ctrl2) {
-            ARISR_RAW_CLEAN_AND_RETURN(kARISR_ERR_GENERIC);
+            ARISR_RAW_CLEAN_ALLOC_AND_RETURN(kARISR_ERR_GENERIC);
         }
-        memset(buffer->ctrl2, 0, ARISR_CTRL2_SECTION_SIZE);
-        ARISR_proto_ctrl_setField(buffer->ctrl2, encrypted_length / ARISR_DATA_MULT, ARISR_CTRL2_DATA_LENGTH_SHIFT);
-        ARISR_proto_ctrl_setField(buffer->ctrl2, data->ctrl2.feature, ARISR_CTRL2_FEATURE_SHIFT);
-        ARISR_proto_ctrl_setField(buffer->ctrl2, data->ctrl2.neg_answer, ARISR_CTRL2_NEG_ANSWER_SHIFT);
-        ARISR_proto_ctrl_setField(buffer->ctrl2, data->ctrl2.freq_switch, ARISR_CTRL2_FREQ_SWITCH_SHIFT);
+        ctrl2 = data->ctrl2;
+        ctrl2.data_length = encrypted_length;
+        ARISR_proto_ctrl2_encode(buffer->ctrl2, &ctrl2);
     }
 
     // Set null CRCs
@@ -770,6 +1652,12 @@ ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARI
     return kARISR_OK;
 }
 
+// =============================================
+ARISR_ERR ARISR_proto_pack(ARISR_CHUNK_RAW *buffer, ARISR_CHUNK *data, const ARISR_AES128_KEY key)
+{
+    return ARISR_proto_pack_alloc(buffer, data, key, &ARISR_DEFAULT_ALLOCATOR);
+}
+
 // =============================================
 ARISR_ERR ARISR_proto_send(ARISR_UINT8 **buffer, ARISR_CHUNK_RAW *data, ARISR_UINT32 *length)
 {
@@ -778,33 +1666,22 @@ ARISR_ERR ARISR_proto_send(ARISR_UINT8 **buffer, ARISR_CHUNK_RAW *data, ARISR_UI
     }
 
     // Pointer to save size of the buffer
-    unsigned int p, size;
-    ARISR_UINT8 dst_num, from, more_headers, data_length;
+    ARISR_UINT32 p, size;
+    ARISR_UINT8 dst_num, from, more_headers;
+    ARISR_UINT32 data_length = 0;
     ARISR_UINT16 crc;
+    ARISR_ERR err;
 
-    // Minimun size of the buffer
-    size = ARISR_PROTO_ID_SIZE + ARISR_PROTO_ARIS_SIZE + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE * 2 + ARISR_CRC_SIZE + ARISR_PROTO_ID_SIZE;
-
-    // Calculate the destinations
-    dst_num = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT);
-    if (dst_num > 0) {
-        size += ARISR_ADDRESS_SIZE * dst_num;
-    }   
-
-    // Get from
-    from = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT);
-    if (from)
-        size += ARISR_ADDRESS_SIZE;
-
-    // Get more headers and check data length
+    dst_num      = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT);
+    from         = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT);
     more_headers = ARISR_proto_ctrl_getField(data->ctrl, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT);
-    if (more_headers) {
+    if (more_headers && data->ctrl2) {
         data_length = ARISR_proto_ctrl_getField(data->ctrl2, ARISR_CTRL2_DATA_LENGTH_MASK, ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT;
-        size += ARISR_CTRL_SECTION_SIZE;
+    }
 
-        if (data_length > 0) {
-            size += data_length + ARISR_CRC_SIZE;
-        }
+    // Exact size of the buffer from the raw control sections
+    if ((err = ARISR_proto_frame_size_raw(data->ctrl, data->ctrl2, &size)) != kARISR_OK) {
+        return err;
     }
 
     // Create the buffer
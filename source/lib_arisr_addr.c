@@ -0,0 +1,250 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_addr.c
+ * @brief This file contains the 48-bit address set used to filter frames by destination.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_addr.h"
+#include "lib_arisr.h"
+
+#define ARISR_ADDR_SET_MAX_CAPACITY (1UL << 28)
+
+/* ===== HASH ===== */
+
+// =============================================
+static inline ARISR_UINT64 ARISR_addr_set_key(const ARISR_UINT8 *address)
+{
+    return ((ARISR_UINT64)address[0] << 40) | ((ARISR_UINT64)address[1] << 32) | ((ARISR_UINT64)address[2] << 24)
+         | ((ARISR_UINT64)address[3] << 16) | ((ARISR_UINT64)address[4] << 8)  |  (ARISR_UINT64)address[5];
+}
+
+// =============================================
+static inline ARISR_UINT32 ARISR_addr_set_bucket(const ARISR_ADDR_SET *set, ARISR_UINT64 key)
+{
+    // Fibonacci hashing: only the top bits of the product depend on every bit of the address
+    return (ARISR_UINT32)((key * 0x9E3779B97F4A7C15ULL) >> set->bucket_shift);
+}
+
+// =============================================
+static ARISR_UINT8 ARISR_addr_set_find(const ARISR_ADDR_SET *set, ARISR_UINT64 key)
+{
+    const ARISR_ADDR_BUCKET *bucket;
+    ARISR_UINT32 b, s;
+
+    b = ARISR_addr_set_bucket(set, key);
+
+    // Slots fill in order and nothing is removed, so an empty slot ends the search
+    for (;;) {
+        bucket = &set->buckets[b];
+        for (s = 0; s < ARISR_ADDR_SET_SLOTS; s++) {
+            if (bucket->slot[s] == key) {
+                return 1;
+            }
+            if (bucket->slot[s] == ARISR_ADDR_SET_EMPTY) {
+                return 0;
+            }
+        }
+        b = (b + 1) & set->bucket_mask;
+    }
+}
+
+/* ===== SET ===== */
+
+// =============================================
+ARISR_ERR ARISR_addr_set_create(ARISR_ADDR_SET *set, ARISR_UINT32 capacity, const ARISR_ALLOCATOR *allocator)
+{
+    ARISR_UINT32 buckets = 2;
+    ARISR_UINT8 shift = 63;
+
+    if (!set || capacity == 0 || capacity > ARISR_ADDR_SET_MAX_CAPACITY) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(set, 0, sizeof(ARISR_ADDR_SET));
+    set->allocator = allocator ? *allocator : ARISR_DEFAULT_ALLOCATOR;
+
+    // At most half of the slots are used, so a full bucket stays the exception.
+    // Two buckets at least, so the hash shift stays below 64.
+    while (buckets * ARISR_ADDR_SET_SLOTS < 2 * capacity) {
+        buckets <<= 1;
+        shift--;
+    }
+
+#if SIZE_MAX <= 0xFFFFFFFFUL
+    // The bucket array must not wrap where size_t is 32 bits
+    if ((size_t)buckets > (SIZE_MAX - ARISR_ADDR_SET_ALIGNMENT) / sizeof(ARISR_ADDR_BUCKET)) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+#endif
+
+    // Extra room to align the buckets on a cache line, allocators only promise ARISR_ARENA_ALIGNMENT
+    set->memory = ARISR_ALLOC(&set->allocator, (size_t)buckets * sizeof(ARISR_ADDR_BUCKET) + ARISR_ADDR_SET_ALIGNMENT - 1);
+    if (!set->memory) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    set->buckets      = (ARISR_ADDR_BUCKET *)(((uintptr_t)set->memory + ARISR_ADDR_SET_ALIGNMENT - 1) & ~(uintptr_t)(ARISR_ADDR_SET_ALIGNMENT - 1));
+    set->bucket_mask  = buckets - 1;
+    set->bucket_shift = shift;
+    set->capacity     = capacity;
+
+    ARISR_addr_set_clear(set);
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_addr_set_destroy(ARISR_ADDR_SET *set)
+{
+    if (!set) {
+        return;
+    }
+
+    if (set->memory) {
+        ARISR_FREE(&set->allocator, set->memory);
+    }
+    memset(set, 0, sizeof(ARISR_ADDR_SET));
+}
+
+// =============================================
+void ARISR_addr_set_clear(ARISR_ADDR_SET *set)
+{
+    if (!set || !set->buckets) {
+        return;
+    }
+
+    memset(set->buckets, 0xFF, ((size_t)set->bucket_mask + 1) * sizeof(ARISR_ADDR_BUCKET));
+    set->count = 0;
+}
+
+// =============================================
+ARISR_ERR ARISR_addr_set_insert(ARISR_ADDR_SET *set, const ARISR_UINT8 *address)
+{
+    ARISR_ADDR_BUCKET *bucket;
+    ARISR_UINT64 key;
+    ARISR_UINT32 b, s;
+
+    if (!set || !set->buckets || !address) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    key = ARISR_addr_set_key(address);
+    b   = ARISR_addr_set_bucket(set, key);
+
+    for (;;) {
+        bucket = &set->buckets[b];
+        for (s = 0; s < ARISR_ADDR_SET_SLOTS; s++) {
+            if (bucket->slot[s] == key) {
+                return kARISR_OK;
+            }
+            if (bucket->slot[s] == ARISR_ADDR_SET_EMPTY) {
+                if (set->count >= set->capacity) {
+                    return kARISR_ERR_BUFFER_OVERFLOW;
+                }
+                bucket->slot[s] = key;
+                set->count++;
+                return kARISR_OK;
+            }
+        }
+        b = (b + 1) & set->bucket_mask;
+    }
+}
+
+// =============================================
+ARISR_UINT8 ARISR_addr_set_contains(const ARISR_ADDR_SET *set, const ARISR_UINT8 *address)
+{
+    if (!set || !set->buckets || !address) {
+        return 0;
+    }
+
+    return ARISR_addr_set_find(set, ARISR_addr_set_key(address));
+}
+
+// =============================================
+ARISR_ERR ARISR_addr_set_match_raw(const ARISR_ADDR_SET *set, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    const ARISR_UINT8 *ctrl, *address;
+    ARISR_UINT32 header, destinations, i;
+
+    if (!set || !set->buckets || !data) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    // CTRL1 gives the number of addresses, which must all be in 'data'
+    if (length < ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+    ctrl = data + ARISR_PROTO_CRYPT_SIZE;
+    ARISR_proto_header_size_raw(ctrl, &header);
+    if (length < header) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+
+    // Destination A follows the origin, then come the B addresses and, on relayed frames, C
+    destinations = ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT);
+    if (ARISR_proto_ctrl_getField(ctrl, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT)) {
+        destinations++;
+    }
+
+    address = ctrl + ARISR_CTRL_SECTION_SIZE + ARISR_ADDRESS_SIZE;
+    for (i = 0; i <= destinations; i++, address += ARISR_ADDRESS_SIZE) {
+        if (ARISR_addr_set_find(set, ARISR_addr_set_key(address))) {
+            return kARISR_OK;
+        }
+    }
+
+    return kARISR_ERR_NOT_ADDRESSED;
+}
+
+// =============================================
+ARISR_ERR ARISR_addr_set_filter(void *user, const ARISR_CHUNK *header)
+{
+    const ARISR_ADDR_SET *set = (const ARISR_ADDR_SET *)user;
+    ARISR_UINT32 i;
+
+    if (!set || !set->buckets || !header) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if (ARISR_addr_set_find(set, ARISR_addr_set_key(header->destinationA))) {
+        return kARISR_OK;
+    }
+    for (i = 0; i < header->ctrl.destinations; i++) {
+        if (ARISR_addr_set_find(set, ARISR_addr_set_key(header->destinationsB[i]))) {
+            return kARISR_OK;
+        }
+    }
+    if (header->ctrl.from && ARISR_addr_set_find(set, ARISR_addr_set_key(header->destinationC))) {
+        return kARISR_OK;
+    }
+
+    return kARISR_ERR_NOT_ADDRESSED;
+}
+
+/* COPYRIGHT ARIS Alliance */
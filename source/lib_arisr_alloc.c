@@ -0,0 +1,164 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_alloc.c
+ * @brief This file contains the pluggable allocator and the bump-pointer arena of the ARISr library.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+
+/* ===== DEFAULT ALLOCATOR ===== */
+
+// =============================================
+static void *ARISR_default_alloc(void *user, size_t size)
+{
+    (void)user;
+    return malloc(size);
+}
+
+// =============================================
+static void ARISR_default_free(void *user, void *ptr)
+{
+    (void)user;
+    free(ptr);
+}
+
+const ARISR_ALLOCATOR ARISR_DEFAULT_ALLOCATOR = { ARISR_default_alloc, ARISR_default_free, NULL };
+
+/* ===== ARENA ===== */
+
+// =============================================
+ARISR_ERR ARISR_arena_init(ARISR_ARENA *arena, void *memory, ARISR_UINT32 capacity)
+{
+    if (!arena || !memory) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    arena->memory   = (ARISR_UINT8 *)memory;
+    arena->capacity = capacity;
+    arena->used     = 0;
+    arena->owned    = 0;
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_arena_create(ARISR_ARENA *arena, ARISR_UINT32 capacity)
+{
+    void *memory;
+
+    if (!arena || capacity == 0) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memory = malloc(capacity);
+    if (!memory) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    ARISR_arena_init(arena, memory, capacity);
+    arena->owned = 1;
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_arena_destroy(ARISR_ARENA *arena)
+{
+    if (!arena) {
+        return;
+    }
+
+    if (arena->owned) {
+        free(arena->memory);
+    }
+    memset(arena, 0, sizeof(ARISR_ARENA));
+}
+
+// =============================================
+void *ARISR_arena_alloc(ARISR_ARENA *arena, size_t size)
+{
+    uintptr_t current;
+    size_t padding;
+    void *block;
+
+    if (!arena || !arena->memory) {
+        return NULL;
+    }
+
+    // Align the absolute address, so caller memory does not need to be aligned itself
+    current = (uintptr_t)(arena->memory + arena->used);
+    padding = (size_t)(-current & (ARISR_ARENA_ALIGNMENT - 1));
+
+    if (padding > arena->capacity - arena->used || size > arena->capacity - arena->used - padding) {
+        return NULL;
+    }
+
+    block = arena->memory + arena->used + padding;
+    arena->used += (ARISR_UINT32)(padding + size);
+
+    return block;
+}
+
+// =============================================
+void ARISR_arena_reset(ARISR_ARENA *arena)
+{
+    if (arena) {
+        arena->used = 0;
+    }
+}
+
+// =============================================
+static void *ARISR_arena_alloc_cb(void *user, size_t size)
+{
+    return ARISR_arena_alloc((ARISR_ARENA *)user, size);
+}
+
+// =============================================
+static void ARISR_arena_free_cb(void *user, void *ptr)
+{
+    // Blocks are released together by ARISR_arena_reset
+    (void)user;
+    (void)ptr;
+}
+
+// =============================================
+ARISR_ERR ARISR_arena_allocator(ARISR_ALLOCATOR *allocator, ARISR_ARENA *arena)
+{
+    if (!allocator || !arena) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    allocator->alloc = ARISR_arena_alloc_cb;
+    allocator->free  = ARISR_arena_free_cb;
+    allocator->user  = arena;
+
+    return kARISR_OK;
+}
+
+/* COPYRIGHT ARIS Alliance */
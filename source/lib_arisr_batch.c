@@ -0,0 +1,160 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_batch.c
+ * @brief This file contains the batch (structure-of-arrays) parser of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_batch.h"
+#include "lib_arisr.h"
+
+// =============================================
+ARISR_ERR ARISR_batch_create(ARISR_BATCH *batch, ARISR_UINT32 capacity, ARISR_UINT32 payload_capacity, const ARISR_ALLOCATOR *allocator)
+{
+    size_t words, bytes;
+    ARISR_UINT8 *p;
+
+    if (!batch || capacity == 0) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(batch, 0, sizeof(ARISR_BATCH));
+    batch->allocator = allocator ? *allocator : ARISR_DEFAULT_ALLOCATOR;
+
+    // 4-byte columns first, then the byte columns and the payload, so every column stays aligned
+    words = (size_t)capacity * (sizeof(ARISR_ERR) + sizeof(ARISR_UINT32) * 2);
+    bytes = (size_t)capacity * (sizeof(ARISR_UINT48) * 2 + 3);
+
+    batch->memory = ARISR_ALLOC(&batch->allocator, words + bytes + payload_capacity);
+    if (!batch->memory) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    p = (ARISR_UINT8 *)batch->memory;
+    batch->status         = (ARISR_ERR *)p;      p += capacity * sizeof(ARISR_ERR);
+    batch->payload_offset = (ARISR_UINT32 *)p;   p += capacity * sizeof(ARISR_UINT32);
+    batch->payload_length = (ARISR_UINT32 *)p;   p += capacity * sizeof(ARISR_UINT32);
+    batch->origin         = (ARISR_UINT48 *)p;   p += capacity * sizeof(ARISR_UINT48);
+    batch->destinationA   = (ARISR_UINT48 *)p;   p += capacity * sizeof(ARISR_UINT48);
+    batch->destinations   = p;                   p += capacity;
+    batch->sequence       = p;                   p += capacity;
+    batch->identifier     = p;                   p += capacity;
+    batch->payload        = p;
+
+    batch->capacity         = capacity;
+    batch->payload_capacity = payload_capacity;
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_batch_destroy(ARISR_BATCH *batch)
+{
+    if (!batch) {
+        return;
+    }
+
+    if (batch->memory) {
+        ARISR_FREE(&batch->allocator, batch->memory);
+    }
+    memset(batch, 0, sizeof(ARISR_BATCH));
+}
+
+// =============================================
+ARISR_ERR ARISR_proto_parse_batch(const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                                  const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id, ARISR_BATCH *batch)
+{
+    ARISR_FRAME_VIEW view;
+    ARISR_UINT32 i, plain_length;
+    ARISR_ERR err;
+
+    if (!frames || !lengths || !ctx || !id || !batch || !batch->memory) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if (count > batch->capacity) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    batch->count = count;
+    batch->valid = 0;
+    batch->payload_used = 0;
+
+    /* ===== PASS 1: HEADERS AND CRC ===== */
+    // Until pass 2, payload_offset/payload_length hold the encrypted section inside the frame
+    for (i = 0; i < count; i++) {
+        batch->payload_offset[i] = 0;
+        batch->payload_length[i] = 0;
+
+        if (!frames[i]) {
+            batch->status[i] = kARISR_ERR_GENERIC;
+            continue;
+        }
+
+        if ((batch->status[i] = ARISR_proto_view_len_ctx(&view, frames[i], lengths[i], ctx, id)) != kARISR_OK) {
+            continue;
+        }
+
+        memcpy(batch->origin[i], view.origin, ARISR_ADDRESS_SIZE);
+        memcpy(batch->destinationA[i], view.destinationA, ARISR_ADDRESS_SIZE);
+        batch->destinations[i]   = view.ctrl.destinations;
+        batch->sequence[i]       = view.ctrl.sequence;
+        batch->identifier[i]     = view.ctrl.identifier;
+        batch->payload_offset[i] = view.data_offset;
+        batch->payload_length[i] = view.ctrl2.data_length;
+    }
+
+    /* ===== PASS 2: DATA ===== */
+    // The key schedule stays hot while every payload is decrypted into the shared buffer
+    for (i = 0; i < count; i++) {
+        if (batch->status[i] != kARISR_OK) {
+            continue;
+        }
+
+        plain_length = 0;
+        if (batch->payload_length[i] > 0) {
+            err = ARISR_aes_data_decrypt_into_ctx(ctx, frames[i] + batch->payload_offset[i], batch->payload_length[i]
+                , batch->payload + batch->payload_used, batch->payload_capacity - batch->payload_used, &plain_length);
+            if (err != kARISR_OK) {
+                batch->status[i] = err;
+                batch->payload_offset[i] = 0;
+                batch->payload_length[i] = 0;
+                continue;
+            }
+        }
+
+        batch->payload_offset[i] = batch->payload_used;
+        batch->payload_length[i] = plain_length;
+        batch->payload_used += plain_length;
+        batch->valid++;
+    }
+
+    return kARISR_OK;
+}
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,249 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_dedup.c
+ * @brief This file contains the duplicate frame cache of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_dedup.h"
+#include "lib_arisr.h"
+
+// Largest capacity, so the number of entries still fits on 32 bits
+#define ARISR_DEDUP_MAX_CAPACITY    (1UL << 30)
+
+/**
+ * @brief Filter state of ARISR_dedup_parse_len_ctx.
+ */
+typedef struct {
+    ARISR_DEDUP *dedup;
+    ARISR_UINT64 now;
+} ARISR_DEDUP_CLOCK;
+
+/* ===== TABLE ===== */
+
+// =============================================
+static inline ARISR_UINT64 ARISR_dedup_load(const ARISR_UINT64 *entry)
+{
+#if ARISR_DEDUP_ATOMIC64
+    return __atomic_load_n(entry, __ATOMIC_RELAXED);
+#else
+    return *entry;
+#endif
+}
+
+// =============================================
+static inline void ARISR_dedup_replace(ARISR_UINT64 *entry, ARISR_UINT64 expected, ARISR_UINT64 value)
+{
+#if ARISR_DEDUP_ATOMIC64
+    __atomic_compare_exchange_n(entry, &expected, value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+    (void)expected;
+    *entry = value;
+#endif
+}
+
+// =============================================
+static ARISR_UINT64 ARISR_dedup_hash(const ARISR_CHUNK *header)
+{
+    ARISR_UINT64 key = 0;
+    ARISR_UINT32 i;
+
+    // Origin (48 bits), identifier (8 bits) and sequence (6 bits) fill one word, the CRC is spread over it
+    for (i = 0; i < ARISR_ADDRESS_SIZE; i++) {
+        key = (key << 8) | header->origin[i];
+    }
+    key |= (ARISR_UINT64)header->ctrl.identifier << 48;
+    key |= (ARISR_UINT64)(header->ctrl.sequence & ((1 << ARISR_CTRL_SEQUENCE_BITS) - 1)) << 56;
+    key ^= (((ARISR_UINT64)header->crc_header[0] << 8) | header->crc_header[1]) * 0x9E3779B97F4A7C15ULL;
+
+    // splitmix64 finalizer, every bit of the key reaches the set index and the tag
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+
+    return key;
+}
+
+// =============================================
+static ARISR_ERR ARISR_dedup_lookup(ARISR_DEDUP *dedup, const ARISR_CHUNK *header, ARISR_UINT64 now, ARISR_UINT8 record)
+{
+    ARISR_UINT64 hash, seen, expected = 0, *set;
+    ARISR_UINT32 tag, time, age, oldest = 0, victim = 0, w;
+
+    hash = ARISR_dedup_hash(header);
+    tag  = (ARISR_UINT32)(hash >> 32);
+    tag  = tag ? tag : 1;                           // Tag 0 marks an empty entry
+    time = (ARISR_UINT32)now;
+    set  = dedup->entries + (size_t)((ARISR_UINT32)hash & dedup->set_mask) * ARISR_DEDUP_WAYS;
+
+    for (w = 0; w < ARISR_DEDUP_WAYS; w++) {
+        seen = ARISR_dedup_load(&set[w]);
+        age  = time - (ARISR_UINT32)seen;
+
+        if ((ARISR_UINT32)(seen >> 32) == tag) {
+            // The window starts at the first copy, later copies do not extend it
+            if (age < dedup->window) {
+#if ARISR_DEDUP_ATOMIC64
+                __atomic_fetch_add(&dedup->duplicates, 1, __ATOMIC_RELAXED);
+#else
+                dedup->duplicates++;
+#endif
+                return kARISR_ERR_DUPLICATE;
+            }
+
+            // Expired copy of the same frame, refreshed in place
+            victim   = w;
+            expected = seen;
+            break;
+        }
+
+        // Empty entries go first, then the oldest one
+        if (seen == 0) {
+            age = ARISR_MAX_UINT32;
+        }
+        if (w == 0 || age > oldest) {
+            oldest   = age;
+            victim   = w;
+            expected = seen;
+        }
+    }
+
+    // A lost race leaves the winner in place, the frame is at worst decoded twice
+    if (record) {
+        ARISR_dedup_replace(&set[victim], expected, ((ARISR_UINT64)tag << 32) | time);
+    }
+
+    return kARISR_OK;
+}
+
+// =============================================
+static ARISR_ERR ARISR_dedup_filter(void *user, const ARISR_CHUNK *header)
+{
+    ARISR_DEDUP_CLOCK *clock = (ARISR_DEDUP_CLOCK *)user;
+
+    return ARISR_dedup_lookup(clock->dedup, header, clock->now, 0);
+}
+
+/* ===== CACHE ===== */
+
+// =============================================
+ARISR_ERR ARISR_dedup_create(ARISR_DEDUP *dedup, ARISR_UINT32 capacity, ARISR_UINT32 window, const ARISR_ALLOCATOR *allocator)
+{
+    ARISR_UINT32 sets = 1;
+
+    if (!dedup || capacity == 0 || capacity > ARISR_DEDUP_MAX_CAPACITY || window == 0 || window > ARISR_DEDUP_MAX_WINDOW) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(dedup, 0, sizeof(ARISR_DEDUP));
+    dedup->allocator = allocator ? *allocator : ARISR_DEFAULT_ALLOCATOR;
+
+    while (sets * ARISR_DEDUP_WAYS < capacity) {
+        sets <<= 1;
+    }
+
+#if SIZE_MAX <= 0xFFFFFFFFUL
+    // The table size must not wrap where size_t is 32 bits
+    if ((size_t)sets > SIZE_MAX / (ARISR_DEDUP_WAYS * sizeof(ARISR_UINT64))) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+#endif
+
+    dedup->entries = (ARISR_UINT64 *)ARISR_ALLOC(&dedup->allocator, (size_t)sets * ARISR_DEDUP_WAYS * sizeof(ARISR_UINT64));
+    if (!dedup->entries) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    dedup->set_mask = sets - 1;
+    dedup->window   = window;
+
+    ARISR_dedup_clear(dedup);
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_dedup_destroy(ARISR_DEDUP *dedup)
+{
+    if (!dedup) {
+        return;
+    }
+
+    if (dedup->entries) {
+        ARISR_FREE(&dedup->allocator, dedup->entries);
+    }
+    memset(dedup, 0, sizeof(ARISR_DEDUP));
+}
+
+// =============================================
+void ARISR_dedup_clear(ARISR_DEDUP *dedup)
+{
+    if (!dedup || !dedup->entries) {
+        return;
+    }
+
+    memset(dedup->entries, 0, ((size_t)dedup->set_mask + 1) * ARISR_DEDUP_WAYS * sizeof(ARISR_UINT64));
+}
+
+// =============================================
+ARISR_ERR ARISR_dedup_check(ARISR_DEDUP *dedup, const ARISR_CHUNK *header, ARISR_UINT64 now)
+{
+    if (!dedup || !dedup->entries || !header) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    return ARISR_dedup_lookup(dedup, header, now, 1);
+}
+
+// =============================================
+ARISR_ERR ARISR_dedup_parse_len_ctx(ARISR_DEDUP *dedup, ARISR_UINT64 now, ARISR_CHUNK *buffer, const ARISR_UINT8 *data, ARISR_UINT32 length,
+                                    const ARISR_KEY_CTX *ctx, ARISR_UINT8 *id)
+{
+    ARISR_DEDUP_CLOCK clock;
+    ARISR_ERR err;
+
+    if (!dedup || !dedup->entries) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    clock.dedup = dedup;
+    clock.now   = now;
+
+    // Only looked up after the header CRC, recorded once the whole frame is valid
+    if ((err = ARISR_proto_parse_len_filtered_ctx(buffer, data, length, ctx, id, ARISR_dedup_filter, &clock)) != kARISR_OK) {
+        return err;
+    }
+
+    ARISR_dedup_lookup(dedup, buffer, now, 1);
+
+    return kARISR_OK;
+}
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,436 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_pool.c
+ * @brief This file contains the multi-threaded batch decoder of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_pool.h"
+#include "lib_arisr.h"
+
+#if ARISR_POOL_THREADS
+
+#include <pthread.h>
+
+typedef enum {
+    ARISR_POOL_JOB_PARSE,
+    ARISR_POOL_JOB_RECV
+} ARISR_POOL_JOB_KIND;
+
+/**
+ * @brief Tasks still owned by a worker, as the range [head, tail) of task indexes.
+ *
+ * The owner takes from 'tail', thieves take from 'head'. Tasks are never pushed
+ * during a batch, so the range only shrinks, except when a thief refills its own
+ * empty deque with the tasks it stole.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    ARISR_UINT32 head;
+    ARISR_UINT32 tail;
+} ARISR_POOL_DEQUE;
+
+// Heap block taken when the arena of a worker is exhausted, released at the next batch
+typedef struct ARISR_POOL_SPILL {
+    struct ARISR_POOL_SPILL *next;
+} ARISR_POOL_SPILL;
+
+#define ARISR_POOL_SPILL_HEADER     ARISR_ARENA_ALIGN(sizeof(ARISR_POOL_SPILL))
+
+typedef struct {
+    ARISR_POOL *pool;
+    ARISR_UINT32 index;
+    pthread_t thread;
+    ARISR_POOL_DEQUE deque;
+    ARISR_KEY_CTX ctx;              // Private key schedule, never shared between threads
+    ARISR_ARENA arena;
+    ARISR_POOL_SPILL *spill;
+    ARISR_ALLOCATOR allocator;      // Arena first, then the heap
+} ARISR_POOL_WORKER;
+
+struct ARISR_POOL {
+    ARISR_UINT32 workers;
+    ARISR_UINT32 started;           // Threads actually running
+    ARISR_POOL_WORKER **worker;     // Allocated one by one, so workers do not share cache lines
+    ARISR_AES128_KEY key;
+
+    pthread_mutex_t call;           // Serializes ARISR_pool_parse / ARISR_pool_recv
+    pthread_mutex_t lock;           // Protects the fields below
+    pthread_cond_t start;
+    pthread_cond_t done;
+    ARISR_UINT32 generation;        // Incremented for every batch
+    ARISR_UINT32 active;            // Workers still busy with the current batch
+    ARISR_UINT8 stop;
+
+    /* ===== CURRENT BATCH ===== */
+    ARISR_POOL_JOB_KIND kind;
+    const ARISR_UINT8 *const *frames;
+    const ARISR_UINT32 *lengths;
+    ARISR_UINT32 count;
+    ARISR_UINT8 *id;
+    void *results;
+    ARISR_ERR *status;
+};
+
+/* ===== WORKER ALLOCATOR ===== */
+
+// =============================================
+static void *ARISR_pool_alloc_cb(void *user, size_t size)
+{
+    ARISR_POOL_WORKER *worker = (ARISR_POOL_WORKER *)user;
+    ARISR_POOL_SPILL *spill;
+    void *block;
+
+    if ((block = ARISR_arena_alloc(&worker->arena, size)) != NULL) {
+        return block;
+    }
+
+    spill = (ARISR_POOL_SPILL *)malloc(ARISR_POOL_SPILL_HEADER + size);
+    if (!spill) {
+        return NULL;
+    }
+
+    spill->next = worker->spill;
+    worker->spill = spill;
+
+    return (ARISR_UINT8 *)spill + ARISR_POOL_SPILL_HEADER;
+}
+
+// =============================================
+static void ARISR_pool_free_cb(void *user, void *ptr)
+{
+    // Blocks are released together at the start of the next batch
+    (void)user;
+    (void)ptr;
+}
+
+// =============================================
+static void ARISR_pool_worker_release(ARISR_POOL_WORKER *worker)
+{
+    ARISR_POOL_SPILL *spill;
+
+    while ((spill = worker->spill) != NULL) {
+        worker->spill = spill->next;
+        free(spill);
+    }
+
+    ARISR_arena_reset(&worker->arena);
+}
+
+/* ===== WORK-STEALING ===== */
+
+// =============================================
+static int ARISR_pool_pop(ARISR_POOL_WORKER *worker, ARISR_UINT32 *task)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&worker->deque.lock);
+    if (worker->deque.head < worker->deque.tail) {
+        *task = --worker->deque.tail;
+        found = 1;
+    }
+    pthread_mutex_unlock(&worker->deque.lock);
+
+    return found;
+}
+
+// =============================================
+static int ARISR_pool_steal(ARISR_POOL_WORKER *worker, ARISR_UINT32 *task)
+{
+    ARISR_POOL *pool = worker->pool;
+    ARISR_POOL_WORKER *victim;
+    ARISR_UINT32 n, head = 0, tail = 0;
+
+    for (n = 1; n < pool->workers; n++) {
+        victim = pool->worker[(worker->index + n) % pool->workers];
+
+        // Take the older half from the front, the victim keeps working on the back
+        pthread_mutex_lock(&victim->deque.lock);
+        if (victim->deque.head < victim->deque.tail) {
+            head = victim->deque.head;
+            tail = head + (victim->deque.tail - head + 1) / 2;
+            victim->deque.head = tail;
+        }
+        pthread_mutex_unlock(&victim->deque.lock);
+
+        if (head < tail) {
+            // Run the first stolen task now and publish the rest, so they can be stolen again
+            *task = head;
+            pthread_mutex_lock(&worker->deque.lock);
+            worker->deque.head = head + 1;
+            worker->deque.tail = tail;
+            pthread_mutex_unlock(&worker->deque.lock);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// =============================================
+static void ARISR_pool_run_task(ARISR_POOL_WORKER *worker, ARISR_UINT32 task)
+{
+    ARISR_POOL *pool = worker->pool;
+    ARISR_UINT32 i, first, last;
+
+    first = task * ARISR_POOL_GRAIN;
+    last = (pool->count - first > ARISR_POOL_GRAIN) ? first + ARISR_POOL_GRAIN : pool->count;
+
+    for (i = first; i < last; i++) {
+        if (!pool->frames[i]) {
+            pool->status[i] = kARISR_ERR_GENERIC;
+            continue;
+        }
+
+        switch (pool->kind) {
+            case ARISR_POOL_JOB_PARSE:
+                pool->status[i] = ARISR_proto_parse_len_ctx_alloc(&((ARISR_CHUNK *)pool->results)[i], pool->frames[i], pool->lengths[i]
+                    , &worker->ctx, pool->id, &worker->allocator);
+                break;
+#if defined(ARISR_PROTO_PARTIAL_FUNCTIONS)
+            case ARISR_POOL_JOB_RECV:
+                pool->status[i] = ARISR_proto_recv_len_alloc(&((ARISR_CHUNK_RAW *)pool->results)[i], pool->frames[i], pool->lengths[i]
+                    , pool->key, pool->id, &worker->allocator);
+                break;
+#endif
+            default:
+                pool->status[i] = kARISR_ERR_GENERIC;
+                break;
+        }
+    }
+}
+
+// =============================================
+static void *ARISR_pool_thread(void *arg)
+{
+    ARISR_POOL_WORKER *worker = (ARISR_POOL_WORKER *)arg;
+    ARISR_POOL *pool = worker->pool;
+    ARISR_UINT32 seen = 0, task;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        // Tasks are never added during a batch: once every deque is empty the worker is done
+        while (ARISR_pool_pop(worker, &task) || ARISR_pool_steal(worker, &task)) {
+            ARISR_pool_run_task(worker, task);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/* ===== POOL ===== */
+
+// =============================================
+ARISR_ERR ARISR_pool_create(ARISR_POOL **pool, ARISR_UINT32 workers, const ARISR_AES128_KEY key, ARISR_UINT32 arena_capacity)
+{
+    ARISR_POOL *p;
+    ARISR_POOL_WORKER *worker;
+    ARISR_UINT32 i;
+    ARISR_ERR err;
+
+    if (!pool || !key || workers == 0 || workers > ARISR_POOL_MAX_WORKERS || arena_capacity == 0) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    *pool = NULL;
+
+    p = (ARISR_POOL *)calloc(1, sizeof(ARISR_POOL));
+    if (!p) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    p->worker = (ARISR_POOL_WORKER **)calloc(workers, sizeof(ARISR_POOL_WORKER *));
+    if (!p->worker) {
+        free(p);
+        return kARISR_ERR_GENERIC;
+    }
+
+    p->workers = workers;
+    memcpy(p->key, key, sizeof(ARISR_AES128_KEY));
+    pthread_mutex_init(&p->call, NULL);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+
+    for (i = 0; i < workers; i++) {
+        worker = (ARISR_POOL_WORKER *)calloc(1, sizeof(ARISR_POOL_WORKER));
+        if (!worker) {
+            ARISR_pool_destroy(p);
+            return kARISR_ERR_GENERIC;
+        }
+
+        worker->pool = p;
+        worker->index = i;
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        p->worker[i] = worker;
+
+        if ((err = ARISR_aes_key_ctx_init(&worker->ctx, key)) != kARISR_OK
+            || (err = ARISR_arena_create(&worker->arena, arena_capacity)) != kARISR_OK) {
+            ARISR_pool_destroy(p);
+            return err;
+        }
+
+        worker->allocator.alloc = ARISR_pool_alloc_cb;
+        worker->allocator.free  = ARISR_pool_free_cb;
+        worker->allocator.user  = worker;
+
+        if (pthread_create(&worker->thread, NULL, ARISR_pool_thread, worker) != 0) {
+            ARISR_pool_destroy(p);
+            return kARISR_ERR_GENERIC;
+        }
+        p->started++;
+    }
+
+    *pool = p;
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_pool_destroy(ARISR_POOL *pool)
+{
+    ARISR_UINT32 i;
+
+    if (!pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    // Threads are started in order, so the first 'started' workers have one
+    for (i = 0; i < pool->started; i++) {
+        pthread_join(pool->worker[i]->thread, NULL);
+    }
+
+    for (i = 0; i < pool->workers; i++) {
+        if (!pool->worker[i]) {
+            continue;
+        }
+        ARISR_pool_worker_release(pool->worker[i]);
+        ARISR_arena_destroy(&pool->worker[i]->arena);
+        pthread_mutex_destroy(&pool->worker[i]->deque.lock);
+        memset(&pool->worker[i]->ctx, 0, sizeof(ARISR_KEY_CTX));
+        free(pool->worker[i]);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->call);
+    memset(pool->key, 0, sizeof(ARISR_AES128_KEY));
+    free(pool->worker);
+    free(pool);
+}
+
+// =============================================
+static ARISR_ERR ARISR_pool_run(ARISR_POOL *pool, ARISR_POOL_JOB_KIND kind, const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[]
+                              , ARISR_UINT32 count, ARISR_UINT8 *id, void *results, ARISR_ERR status[])
+{
+    ARISR_POOL_WORKER *worker;
+    ARISR_UINT32 i, tasks;
+
+    if (!pool || !frames || !lengths || !id || !results || !status) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    pthread_mutex_lock(&pool->call);
+
+    // Results of the previous batch are dropped here, the workers are idle
+    tasks = (ARISR_UINT32)(((uint64_t)count + ARISR_POOL_GRAIN - 1) / ARISR_POOL_GRAIN);
+    for (i = 0; i < pool->workers; i++) {
+        worker = pool->worker[i];
+        ARISR_pool_worker_release(worker);
+
+        // Contiguous ranges, so each worker starts on frames next to each other
+        worker->deque.head = (ARISR_UINT32)(((uint64_t)tasks * i) / pool->workers);
+        worker->deque.tail = (ARISR_UINT32)(((uint64_t)tasks * (i + 1)) / pool->workers);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->kind    = kind;
+    pool->frames  = frames;
+    pool->lengths = lengths;
+    pool->count   = count;
+    pool->id      = id;
+    pool->results = results;
+    pool->status  = status;
+    pool->active  = pool->workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->call);
+
+    return kARISR_OK;
+}
+
+// =============================================
+ARISR_ERR ARISR_pool_parse(ARISR_POOL *pool, const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                           ARISR_UINT8 *id, ARISR_CHUNK results[], ARISR_ERR status[])
+{
+    return ARISR_pool_run(pool, ARISR_POOL_JOB_PARSE, frames, lengths, count, id, results, status);
+}
+
+#if defined(ARISR_PROTO_PARTIAL_FUNCTIONS)
+
+// =============================================
+ARISR_ERR ARISR_pool_recv(ARISR_POOL *pool, const ARISR_UINT8 *const frames[], const ARISR_UINT32 lengths[], ARISR_UINT32 count,
+                          ARISR_UINT8 *id, ARISR_CHUNK_RAW results[], ARISR_ERR status[])
+{
+    return ARISR_pool_run(pool, ARISR_POOL_JOB_RECV, frames, lengths, count, id, results, status);
+}
+
+#endif // ARISR_PROTO_PARTIAL_FUNCTIONS
+
+#endif // ARISR_POOL_THREADS
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,445 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_reasm.c
+ * @brief This file contains the fragment reassembly of the ARISr protocol (more_data sequences).
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_alloc.h"
+#include "lib_arisr_reasm.h"
+
+#define ARISR_REASM_FREE        0
+#define ARISR_REASM_PENDING     1
+#define ARISR_REASM_DELIVERED   2
+
+#define ARISR_REASM_NO_LAST     0xFF
+
+/* ===== INDEX ===== */
+
+// =============================================
+static ARISR_UINT32 ARISR_reasm_hash(const ARISR_REASM *reasm, const ARISR_UINT8 *origin, ARISR_UINT8 identifier)
+{
+    ARISR_UINT64 key = 0;
+    ARISR_UINT8 i;
+
+    for (i = 0; i < ARISR_ADDRESS_SIZE; i++) {
+        key = (key << 8) | origin[i];
+    }
+    key = (key << 8) | identifier;
+
+    // Fibonacci hashing: only the top bits of the product are well mixed
+    return (ARISR_UINT32)((key * 0x9E3779B97F4A7C15ULL) >> reasm->index_shift);
+}
+
+// =============================================
+static ARISR_UINT32 ARISR_reasm_find(const ARISR_REASM *reasm, const ARISR_UINT8 *origin, ARISR_UINT8 identifier)
+{
+    ARISR_UINT32 bucket = ARISR_reasm_hash(reasm, origin, identifier);
+    const ARISR_REASM_ENTRY *entry;
+
+    // Linear probing, the index is at least twice the number of entries
+    while (reasm->index[bucket] != ARISR_REASM_NONE) {
+        entry = &reasm->entries[reasm->index[bucket]];
+        if (entry->identifier == identifier && memcmp(entry->origin, origin, ARISR_ADDRESS_SIZE) == 0) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & reasm->index_mask;
+    }
+
+    return bucket;
+}
+
+// =============================================
+static void ARISR_reasm_unindex(ARISR_REASM *reasm, ARISR_UINT32 bucket)
+{
+    ARISR_UINT32 next = bucket, home;
+    const ARISR_REASM_ENTRY *entry;
+
+    // Backward shift deletion: no tombstones, probe chains stay short
+    for (;;) {
+        next = (next + 1) & reasm->index_mask;
+        if (reasm->index[next] == ARISR_REASM_NONE) {
+            break;
+        }
+
+        entry = &reasm->entries[reasm->index[next]];
+        home = ARISR_reasm_hash(reasm, entry->origin, entry->identifier);
+
+        // Move it back unless its home bucket lies cyclically in (bucket, next]
+        if (((next - home) & reasm->index_mask) >= ((next - bucket) & reasm->index_mask)) {
+            reasm->index[bucket] = reasm->index[next];
+            bucket = next;
+        }
+    }
+
+    reasm->index[bucket] = ARISR_REASM_NONE;
+}
+
+/* ===== ENTRIES ===== */
+
+// =============================================
+static void ARISR_reasm_age_remove(ARISR_REASM *reasm, ARISR_UINT16 slot)
+{
+    ARISR_REASM_ENTRY *entry = &reasm->entries[slot];
+
+    if (entry->prev != ARISR_REASM_NONE) {
+        reasm->entries[entry->prev].next = entry->next;
+    } else {
+        reasm->oldest = entry->next;
+    }
+
+    if (entry->next != ARISR_REASM_NONE) {
+        reasm->entries[entry->next].prev = entry->prev;
+    } else {
+        reasm->newest = entry->prev;
+    }
+
+    entry->prev = entry->next = ARISR_REASM_NONE;
+}
+
+// =============================================
+static void ARISR_reasm_free_entry(ARISR_REASM *reasm, ARISR_UINT16 slot)
+{
+    ARISR_REASM_ENTRY *entry = &reasm->entries[slot];
+    ARISR_UINT32 s;
+
+    for (s = 0; s < ARISR_REASM_MAX_FRAGMENTS; s++) {
+        if (entry->slab[s] != ARISR_REASM_NONE) {
+            reasm->free_slabs[reasm->free_slab_count++] = entry->slab[s];
+            entry->slab[s] = ARISR_REASM_NONE;
+        }
+    }
+
+    entry->state = ARISR_REASM_FREE;
+    reasm->free_entries[reasm->free_entry_count++] = slot;
+}
+
+// =============================================
+static void ARISR_reasm_evict(ARISR_REASM *reasm, ARISR_UINT16 slot)
+{
+    ARISR_REASM_ENTRY *entry = &reasm->entries[slot];
+
+    ARISR_reasm_unindex(reasm, ARISR_reasm_find(reasm, entry->origin, entry->identifier));
+    ARISR_reasm_age_remove(reasm, slot);
+    ARISR_reasm_free_entry(reasm, slot);
+    reasm->evicted++;
+}
+
+// =============================================
+static int ARISR_reasm_evict_oldest(ARISR_REASM *reasm, ARISR_UINT16 keep)
+{
+    ARISR_UINT16 victim = reasm->oldest;
+
+    if (victim == keep && victim != ARISR_REASM_NONE) {
+        victim = reasm->entries[victim].next;
+    }
+    if (victim == ARISR_REASM_NONE) {
+        return 0;
+    }
+
+    ARISR_reasm_evict(reasm, victim);
+    return 1;
+}
+
+// =============================================
+static void ARISR_reasm_deliver(ARISR_REASM *reasm, ARISR_UINT16 slot, ARISR_UINT32 bucket, ARISR_REASM_MESSAGE *message)
+{
+    ARISR_REASM_ENTRY *entry = &reasm->entries[slot];
+    ARISR_UINT32 s;
+
+    // The key is free again for the next message, the slabs stay until ARISR_reasm_release
+    ARISR_reasm_unindex(reasm, bucket);
+    ARISR_reasm_age_remove(reasm, slot);
+    entry->state = ARISR_REASM_DELIVERED;
+
+    memcpy(message->origin, entry->origin, ARISR_ADDRESS_SIZE);
+    message->identifier = entry->identifier;
+    message->slot = slot;
+    message->count = (ARISR_UINT32)entry->last + 1;
+    message->length = 0;
+
+    for (s = 0; s < message->count; s++) {
+        message->iov[s].base = reasm->slabs + (size_t)entry->slab[s] * reasm->slab_size;
+        message->iov[s].length = entry->length[s];
+        message->length += entry->length[s];
+    }
+
+    reasm->completed++;
+}
+
+/* ===== REASSEMBLER ===== */
+
+// =============================================
+ARISR_ERR ARISR_reasm_create(ARISR_REASM *reasm, ARISR_UINT32 max_messages, ARISR_UINT32 slab_count, ARISR_UINT32 slab_size,
+                             ARISR_UINT64 timeout, const ARISR_ALLOCATOR *allocator)
+{
+    size_t entries_size, index_size, stacks_size;
+    ARISR_UINT32 buckets = 1, i;
+    ARISR_UINT8 shift = 64;
+    ARISR_UINT8 *p;
+
+    if (!reasm || max_messages == 0 || max_messages >= ARISR_REASM_NONE || slab_count == 0 || slab_count >= ARISR_REASM_NONE
+        || slab_size == 0 || slab_size > ARISR_MAX_UINT16) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(reasm, 0, sizeof(ARISR_REASM));
+    reasm->allocator = allocator ? *allocator : ARISR_DEFAULT_ALLOCATOR;
+
+    // At least two buckets, so the hash shift stays below 64
+    while (buckets < 2 * max_messages) {
+        buckets <<= 1;
+        shift--;
+    }
+
+    entries_size = ARISR_ARENA_ALIGN((size_t)max_messages * sizeof(ARISR_REASM_ENTRY));
+    index_size   = ARISR_ARENA_ALIGN((size_t)buckets * sizeof(ARISR_UINT16));
+    stacks_size  = ARISR_ARENA_ALIGN(((size_t)max_messages + slab_count) * sizeof(ARISR_UINT16));
+
+    reasm->memory = ARISR_ALLOC(&reasm->allocator, entries_size + index_size + stacks_size + (size_t)slab_count * slab_size);
+    if (!reasm->memory) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    p = (ARISR_UINT8 *)reasm->memory;
+    reasm->entries      = (ARISR_REASM_ENTRY *)p;   p += entries_size;
+    reasm->index        = (ARISR_UINT16 *)p;        p += index_size;
+    reasm->free_entries = (ARISR_UINT16 *)p;
+    reasm->free_slabs   = reasm->free_entries + max_messages;
+    p += stacks_size;
+    reasm->slabs        = p;
+
+    reasm->max_messages = max_messages;
+    reasm->slab_count   = slab_count;
+    reasm->slab_size    = slab_size;
+    reasm->timeout      = timeout;
+    reasm->index_mask   = buckets - 1;
+    reasm->index_shift  = shift;
+    reasm->oldest       = ARISR_REASM_NONE;
+    reasm->newest       = ARISR_REASM_NONE;
+
+    memset(reasm->index, 0xFF, (size_t)buckets * sizeof(ARISR_UINT16));
+    memset(reasm->entries, 0, (size_t)max_messages * sizeof(ARISR_REASM_ENTRY));
+
+    // Stacks are filled backwards so entry 0 and slab 0 are used first
+    for (i = 0; i < max_messages; i++) {
+        memset(reasm->entries[i].slab, 0xFF, sizeof(reasm->entries[i].slab));
+        reasm->free_entries[i] = (ARISR_UINT16)(max_messages - 1 - i);
+    }
+    for (i = 0; i < slab_count; i++) {
+        reasm->free_slabs[i] = (ARISR_UINT16)(slab_count - 1 - i);
+    }
+    reasm->free_entry_count = max_messages;
+    reasm->free_slab_count  = slab_count;
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_reasm_destroy(ARISR_REASM *reasm)
+{
+    if (!reasm) {
+        return;
+    }
+
+    if (reasm->memory) {
+        ARISR_FREE(&reasm->allocator, reasm->memory);
+    }
+    memset(reasm, 0, sizeof(ARISR_REASM));
+}
+
+// =============================================
+void ARISR_reasm_expire(ARISR_REASM *reasm, ARISR_UINT64 now)
+{
+    if (!reasm || !reasm->memory || reasm->timeout == 0) {
+        return;
+    }
+
+    // Entries are in creation order, so only the expired head of the list is touched
+    while (reasm->oldest != ARISR_REASM_NONE && now - reasm->entries[reasm->oldest].created >= reasm->timeout) {
+        ARISR_reasm_evict(reasm, reasm->oldest);
+    }
+}
+
+// =============================================
+ARISR_ERR ARISR_reasm_push(ARISR_REASM *reasm, const ARISR_CHUNK *chunk, ARISR_UINT64 now, ARISR_REASM_MESSAGE *message)
+{
+    ARISR_REASM_ENTRY *entry;
+    ARISR_UINT32 bucket, length, sequence;
+    ARISR_UINT16 slot, slab;
+
+    if (!reasm || !reasm->memory || !chunk || !message) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    message->count = 0;
+    message->length = 0;
+    message->slot = ARISR_REASM_NONE;
+
+    length = chunk->ctrl2.data_length;
+    sequence = chunk->ctrl.sequence;
+
+    if (length > 0 && !chunk->data) {
+        return kARISR_ERR_GENERIC;
+    }
+    if (length > reasm->slab_size) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+    // 'received', 'slab' and 'length' hold one entry per sequence value
+    if (sequence >= ARISR_REASM_MAX_FRAGMENTS) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    ARISR_reasm_expire(reasm, now);
+
+    bucket = ARISR_reasm_find(reasm, chunk->origin, chunk->ctrl.identifier);
+    slot = reasm->index[bucket];
+
+    /* ===== SINGLE FRAME ===== */
+    if (slot == ARISR_REASM_NONE && !chunk->ctrl.more_data && sequence == 0) {
+        memcpy(message->origin, chunk->origin, ARISR_ADDRESS_SIZE);
+        message->identifier = chunk->ctrl.identifier;
+        message->count = 1;
+        message->length = length;
+        message->iov[0].base = chunk->data;
+        message->iov[0].length = length;
+        reasm->completed++;
+        return kARISR_OK;
+    }
+
+    /* ===== NEW MESSAGE ===== */
+    if (slot == ARISR_REASM_NONE) {
+        if (reasm->free_entry_count == 0) {
+            ARISR_reasm_evict_oldest(reasm, ARISR_REASM_NONE);
+            // The eviction may have shifted the index
+            bucket = ARISR_reasm_find(reasm, chunk->origin, chunk->ctrl.identifier);
+        }
+        if (reasm->free_entry_count == 0) {
+            return kARISR_ERR_GENERIC;
+        }
+
+        slot = reasm->free_entries[--reasm->free_entry_count];
+        entry = &reasm->entries[slot];
+        memcpy(entry->origin, chunk->origin, ARISR_ADDRESS_SIZE);
+        entry->identifier = chunk->ctrl.identifier;
+        entry->last = ARISR_REASM_NO_LAST;
+        entry->state = ARISR_REASM_PENDING;
+        entry->received = 0;
+        entry->created = now;
+
+        entry->next = ARISR_REASM_NONE;
+        entry->prev = reasm->newest;
+        if (reasm->newest != ARISR_REASM_NONE) {
+            reasm->entries[reasm->newest].next = slot;
+        } else {
+            reasm->oldest = slot;
+        }
+        reasm->newest = slot;
+
+        reasm->index[bucket] = slot;
+    }
+
+    entry = &reasm->entries[slot];
+
+    /* ===== FRAGMENT ===== */
+    if (entry->received & ((ARISR_UINT64)1 << sequence)) {
+        reasm->duplicates++;
+        return kARISR_OK;
+    }
+
+    if (reasm->free_slab_count == 0) {
+        while (reasm->free_slab_count == 0 && ARISR_reasm_evict_oldest(reasm, slot)) {
+        }
+        if (reasm->free_slab_count == 0) {
+            return kARISR_ERR_GENERIC;
+        }
+        bucket = ARISR_reasm_find(reasm, chunk->origin, chunk->ctrl.identifier);
+    }
+
+    // The only copy of the fragment
+    slab = reasm->free_slabs[--reasm->free_slab_count];
+    if (length > 0) {
+        memcpy(reasm->slabs + (size_t)slab * reasm->slab_size, chunk->data, length);
+    }
+    entry->slab[sequence] = slab;
+    entry->length[sequence] = (ARISR_UINT16)length;
+    entry->received |= (ARISR_UINT64)1 << sequence;
+
+    if (!chunk->ctrl.more_data) {
+        entry->last = (ARISR_UINT8)sequence;
+    }
+
+    /* ===== COMPLETE ===== */
+    if (entry->last != ARISR_REASM_NO_LAST &&
+        (entry->received & (((ARISR_UINT64)2 << entry->last) - 1)) == (((ARISR_UINT64)2 << entry->last) - 1)) {
+        ARISR_reasm_deliver(reasm, slot, bucket, message);
+    }
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_reasm_release(ARISR_REASM *reasm, ARISR_REASM_MESSAGE *message)
+{
+    if (!reasm || !reasm->memory || !message) {
+        return;
+    }
+
+    if (message->slot != ARISR_REASM_NONE && message->slot < reasm->max_messages
+        && reasm->entries[message->slot].state == ARISR_REASM_DELIVERED) {
+        ARISR_reasm_free_entry(reasm, message->slot);
+    }
+
+    message->slot = ARISR_REASM_NONE;
+    message->count = 0;
+    message->length = 0;
+}
+
+// =============================================
+ARISR_ERR ARISR_reasm_copy(const ARISR_REASM_MESSAGE *message, ARISR_UINT8 *output, ARISR_UINT32 capacity)
+{
+    ARISR_UINT32 s, p = 0;
+
+    if (!message || (!output && message->length > 0)) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    if (message->length > capacity) {
+        return kARISR_ERR_BUFFER_OVERFLOW;
+    }
+
+    for (s = 0; s < message->count; s++) {
+        if (message->iov[s].length > 0) {
+            memcpy(output + p, message->iov[s].base, message->iov[s].length);
+            p += message->iov[s].length;
+        }
+    }
+
+    return kARISR_OK;
+}
+
+/* COPYRIGHT ARIS Alliance */
@@ -0,0 +1,499 @@
+/**
+ * @attention
+
+    Copyright (C) 2025  - ARIS Alliance
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+ **********************************************************************************
+ * @file lib_arisr_scan.c
+ * @brief This file contains the byte-stream frame scanner of the ARISr protocol.
+ * @date 2025-01-30
+ * @authors ARIS Alliance
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib_arisr_base.h"
+#include "lib_arisr_err.h"
+#include "lib_arisr_scan.h"
+#include "lib_arisr.h"
+
+#if ARISR_SCAN_SIMD_X86
+#include <immintrin.h>
+#elif ARISR_SCAN_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/* ===== FRAME START AUTOMATON ===== */
+
+// =============================================
+static void ARISR_scanner_build_fail(ARISR_SCANNER *scanner)
+{
+    ARISR_UINT8 i, k = 0;
+
+    // fail[i] is the longest proper border of pattern[0, i)
+    scanner->fail[0] = 0;
+    scanner->fail[1] = 0;
+    for (i = 1; i < ARISR_SCANNER_PATTERN_SIZE; i++) {
+        while (k > 0 && scanner->pattern[i] != scanner->pattern[k]) {
+            k = scanner->fail[k];
+        }
+        if (scanner->pattern[i] == scanner->pattern[k]) {
+            k++;
+        }
+        scanner->fail[i + 1] = k;
+    }
+}
+
+// =============================================
+static inline int ARISR_scanner_step(ARISR_SCANNER *scanner, ARISR_UINT8 byte)
+{
+    ARISR_UINT8 m = scanner->match;
+
+    while (m > 0 && byte != scanner->pattern[m]) {
+        m = scanner->fail[m];
+    }
+    if (byte == scanner->pattern[m]) {
+        m++;
+    }
+
+    if (m == ARISR_SCANNER_PATTERN_SIZE) {
+        scanner->match = scanner->fail[m];
+        return 1;
+    }
+
+    scanner->match = m;
+    return 0;
+}
+
+/* ===== FRAME START SEARCH ===== */
+
+// =============================================
+static ARISR_UINT32 ARISR_scanner_find_scalar(const ARISR_UINT8 *pattern, const ARISR_UINT8 *data, ARISR_UINT32 i, ARISR_UINT32 length)
+{
+    const ARISR_UINT8 *p;
+
+    // memchr is vectorized by most C libraries, the rest of the start is checked only on a hit
+    while (length - i >= ARISR_SCANNER_PATTERN_SIZE) {
+        p = (const ARISR_UINT8 *)memchr(data + i, pattern[0], length - i - ARISR_SCANNER_PATTERN_SIZE + 1);
+        if (!p) {
+            break;
+        }
+
+        i = (ARISR_UINT32)(p - data);
+        if (data[i + ARISR_PROTO_ID_SIZE] == pattern[ARISR_PROTO_ID_SIZE] && memcmp(data + i, pattern, ARISR_SCANNER_PATTERN_SIZE) == 0) {
+            return i;
+        }
+        i++;
+    }
+
+    return length;
+}
+
+#if ARISR_SCAN_SIMD_X86
+
+#define ARISR_SCAN_AVX2_TARGET __attribute__((target("avx2")))
+
+// =============================================
+static int ARISR_scanner_avx2_available(void)
+{
+    // 0 = unknown, 1 = no, 2 = yes. A race only repeats the same query
+    static int state = 0;
+    int s = __atomic_load_n(&state, __ATOMIC_RELAXED);
+
+    if (s == 0) {
+        __builtin_cpu_init();
+        s = __builtin_cpu_supports("avx2") ? 2 : 1;
+        __atomic_store_n(&state, s, __ATOMIC_RELAXED);
+    }
+    return s == 2;
+}
+
+// =============================================
+ARISR_SCAN_AVX2_TARGET static ARISR_UINT32 ARISR_scanner_find_avx2(const ARISR_UINT8 *pattern, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    const __m256i first = _mm256_set1_epi8((char)pattern[0]);
+    const __m256i aris  = _mm256_set1_epi8((char)pattern[ARISR_PROTO_ID_SIZE]);
+    ARISR_UINT32 i, bit, mask;
+
+    // First ID byte and first ARIS byte compared for 32 starts at once, 'data[i + 35]' is the last byte read
+    for (i = 0; length - i >= 32 + ARISR_PROTO_ID_SIZE; i += 32) {
+        mask = (ARISR_UINT32)_mm256_movemask_epi8(_mm256_and_si256(
+                    _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + i)), first),
+                    _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(data + i + ARISR_PROTO_ID_SIZE)), aris)));
+        while (mask) {
+            bit = (ARISR_UINT32)__builtin_ctz(mask);
+            if (length - i - bit >= ARISR_SCANNER_PATTERN_SIZE && memcmp(data + i + bit, pattern, ARISR_SCANNER_PATTERN_SIZE) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return ARISR_scanner_find_scalar(pattern, data, i, length);
+}
+
+// =============================================
+static ARISR_UINT32 ARISR_scanner_find_sse2(const ARISR_UINT8 *pattern, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    const __m128i first = _mm_set1_epi8((char)pattern[0]);
+    const __m128i aris  = _mm_set1_epi8((char)pattern[ARISR_PROTO_ID_SIZE]);
+    ARISR_UINT32 i, bit, mask;
+
+    for (i = 0; length - i >= 16 + ARISR_PROTO_ID_SIZE; i += 16) {
+        mask = (ARISR_UINT32)_mm_movemask_epi8(_mm_and_si128(
+                    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)), first),
+                    _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i + ARISR_PROTO_ID_SIZE)), aris)));
+        while (mask) {
+            bit = (ARISR_UINT32)__builtin_ctz(mask);
+            if (length - i - bit >= ARISR_SCANNER_PATTERN_SIZE && memcmp(data + i + bit, pattern, ARISR_SCANNER_PATTERN_SIZE) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return ARISR_scanner_find_scalar(pattern, data, i, length);
+}
+
+#elif ARISR_SCAN_SIMD_NEON
+
+// =============================================
+static ARISR_UINT32 ARISR_scanner_find_neon(const ARISR_UINT8 *pattern, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    const uint8x16_t first = vdupq_n_u8(pattern[0]);
+    const uint8x16_t aris  = vdupq_n_u8(pattern[ARISR_PROTO_ID_SIZE]);
+    uint8x16_t eq;
+    uint64_t mask;
+    ARISR_UINT32 i, bit;
+
+    for (i = 0; length - i >= 16 + ARISR_PROTO_ID_SIZE; i += 16) {
+        eq = vandq_u8(vceqq_u8(vld1q_u8(data + i), first), vceqq_u8(vld1q_u8(data + i + ARISR_PROTO_ID_SIZE), aris));
+
+        // No movemask on NEON: narrowing by 4 bits leaves one nibble per start
+        mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            bit = (ARISR_UINT32)__builtin_ctzll(mask) >> 2;
+            if (length - i - bit >= ARISR_SCANNER_PATTERN_SIZE && memcmp(data + i + bit, pattern, ARISR_SCANNER_PATTERN_SIZE) == 0) {
+                return i + bit;
+            }
+            mask &= ~((uint64_t)0xF << (bit * 4));
+        }
+    }
+
+    return ARISR_scanner_find_scalar(pattern, data, i, length);
+}
+
+#endif
+
+// =============================================
+ARISR_UINT32 ARISR_scanner_find(const ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    if (!scanner || !data) {
+        return length;
+    }
+
+#if ARISR_SCAN_SIMD_X86
+    if (ARISR_scanner_avx2_available()) {
+        return ARISR_scanner_find_avx2(scanner->pattern, data, length);
+    }
+    return ARISR_scanner_find_sse2(scanner->pattern, data, length);
+#elif ARISR_SCAN_SIMD_NEON
+    return ARISR_scanner_find_neon(scanner->pattern, data, length);
+#else
+    return ARISR_scanner_find_scalar(scanner->pattern, data, 0, length);
+#endif
+}
+
+// =============================================
+static int ARISR_scanner_hunt(ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length, ARISR_UINT32 *pos)
+{
+    ARISR_UINT32 p = *pos, found;
+
+    while (p < length) {
+        // A start split with the previous chunk continues byte by byte
+        if (scanner->match > 0) {
+            if (ARISR_scanner_step(scanner, data[p++])) {
+                *pos = p;
+                return 1;
+            }
+            continue;
+        }
+
+        found = ARISR_scanner_find(scanner, data + p, length - p);
+        if (found < length - p) {
+            // Same state the automaton would reach after the first full match
+            scanner->match = scanner->fail[ARISR_SCANNER_PATTERN_SIZE];
+            *pos = p + found + ARISR_SCANNER_PATTERN_SIZE;
+            return 1;
+        }
+
+        // No full start left: only the last bytes can begin one that ends in the next chunk
+        if (length - p > ARISR_SCANNER_PATTERN_SIZE - 1) {
+            p = length - (ARISR_SCANNER_PATTERN_SIZE - 1);
+        }
+        for (; p < length; p++) {
+            ARISR_scanner_step(scanner, data[p]);
+        }
+    }
+
+    *pos = p;
+    return 0;
+}
+
+/* ===== CANDIDATE CHECK ===== */
+
+/**
+ * @brief Checks as much of a candidate frame as 'available' allows.
+ *
+ * @return kARISR_OK with *needed = frame size when the frame is complete and valid,
+ *         kARISR_ERR_INVALID_LENGTH with *needed = bytes required for the next step,
+ *         kARISR_ERR_NOT_SAME_CRC_HEADER or kARISR_ERR_NOT_SAME_END if it is not a frame.
+ */
+static ARISR_ERR ARISR_scanner_check(const ARISR_SCANNER *scanner, const ARISR_UINT8 *frame, ARISR_UINT32 available
+                                   , ARISR_UINT8 *header_ok, ARISR_UINT32 *needed)
+{
+    const ARISR_UINT8 *ctrl = frame + ARISR_PROTO_CRYPT_SIZE;
+    ARISR_UINT32 header, size;
+    ARISR_UINT16 crc;
+
+    // 1- CTRL1 gives the header size
+    if (available < ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE) {
+        *needed = ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE;
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+    ARISR_proto_header_size_raw(ctrl, &header);
+
+    // 2- Header CRC, checked once per candidate
+    if (available < header + ARISR_CRC_SIZE) {
+        *needed = header + ARISR_CRC_SIZE;
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+    if (!*header_ok) {
+        crc = ((ARISR_UINT16)frame[header] << 8) | frame[header + 1];
+        if (ARISR_crypt_crc16_calculate(frame, header) != crc) {
+            return kARISR_ERR_NOT_SAME_CRC_HEADER;
+        }
+        *header_ok = 1;
+    }
+
+    // 3- CTRL2 (if any) gives the data section, then the end mark closes the frame
+    ARISR_proto_frame_size_raw(ctrl, frame + header - ARISR_CTRL2_SECTION_SIZE, &size);
+    *needed = size;
+    if (available < size) {
+        return kARISR_ERR_INVALID_LENGTH;
+    }
+
+    if (memcmp(frame + size - ARISR_PROTO_ID_SIZE, scanner->pattern, ARISR_PROTO_ID_SIZE) != 0) {
+        return kARISR_ERR_NOT_SAME_END;
+    }
+
+    return kARISR_OK;
+}
+
+/* ===== WINDOW ===== */
+
+// =============================================
+static void ARISR_scanner_clear(ARISR_SCANNER *scanner)
+{
+    scanner->start = 0;
+    scanner->end = 0;
+    scanner->cand_head = 0;
+    scanner->cand_count = 0;
+    scanner->need = 0;
+    scanner->header_ok = 0;
+}
+
+// =============================================
+static void ARISR_scanner_compact(ARISR_SCANNER *scanner)
+{
+    ARISR_UINT32 i, n = scanner->cand_count - scanner->cand_head;
+
+    // The window never exceeds one frame and 'start' is past one frame here, so this is amortized O(1)
+    memmove(scanner->buffer, scanner->buffer + scanner->start, scanner->end - scanner->start);
+    for (i = 0; i < n; i++) {
+        scanner->candidates[i] = (ARISR_UINT16)(scanner->candidates[scanner->cand_head + i] - scanner->start);
+    }
+
+    scanner->end -= scanner->start;
+    scanner->start = 0;
+    scanner->cand_head = 0;
+    scanner->cand_count = n;
+}
+
+// =============================================
+static void ARISR_scanner_append(ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    ARISR_UINT32 i;
+
+    if (scanner->end + length > ARISR_SCANNER_BUFFER_SIZE) {
+        ARISR_scanner_compact(scanner);
+    }
+
+    // Later frame starts are recorded on the way in, so a resync never looks at these bytes again
+    for (i = 0; i < length; i++) {
+        scanner->buffer[scanner->end++] = data[i];
+        if (ARISR_scanner_step(scanner, data[i]) && scanner->cand_count < ARISR_SCANNER_MAX_CANDIDATES) {
+            scanner->candidates[scanner->cand_count++] = (ARISR_UINT16)(scanner->end - ARISR_SCANNER_PATTERN_SIZE);
+        }
+    }
+}
+
+// =============================================
+static void ARISR_scanner_next_candidate(ARISR_SCANNER *scanner)
+{
+    // Starts inside a discarded region are not candidates anymore
+    while (scanner->cand_head < scanner->cand_count && scanner->candidates[scanner->cand_head] < scanner->start) {
+        scanner->cand_head++;
+    }
+
+    if (scanner->cand_head == scanner->cand_count) {
+        // A pending partial match stays in 'match': its bytes equal the pattern and are not needed
+        ARISR_scanner_clear(scanner);
+        return;
+    }
+
+    scanner->start = scanner->candidates[scanner->cand_head++];
+    scanner->need = 0;
+    scanner->header_ok = 0;
+}
+
+// =============================================
+static void ARISR_scanner_emit(ARISR_SCANNER *scanner, ARISR_UINT32 size, ARISR_SCANNER_CB callback, void *user)
+{
+    scanner->frames++;
+    callback(user, scanner->buffer + scanner->start, size);
+
+    scanner->start += size;
+    if (scanner->start == scanner->end) {
+        scanner->match = 0;
+        ARISR_scanner_clear(scanner);
+        return;
+    }
+
+    // Bytes after the frame were already fed to the automaton: keep only a match that starts after it
+    while (scanner->match > scanner->end - scanner->start) {
+        scanner->match = scanner->fail[scanner->match];
+    }
+    ARISR_scanner_next_candidate(scanner);
+}
+
+/* ===== SCANNER ===== */
+
+// =============================================
+ARISR_ERR ARISR_scanner_init(ARISR_SCANNER *scanner, const ARISR_KEY_CTX *ctx, const ARISR_UINT8 *id)
+{
+    ARISR_UINT8 i;
+
+    if (!scanner || !ctx || !id) {
+        return kARISR_ERR_INVALID_ARGUMENT;
+    }
+
+    memcpy(scanner->pattern, id, ARISR_PROTO_ID_SIZE);
+    for (i = 0; i < ARISR_PROTO_ARIS_SIZE; i++) {
+        scanner->pattern[ARISR_PROTO_ID_SIZE + i] = (ARISR_UINT8)(ARISR_PROTO_ARIS_TEXT[i] + ctx->aris);
+    }
+    ARISR_scanner_build_fail(scanner);
+    ARISR_scanner_reset(scanner);
+
+    return kARISR_OK;
+}
+
+// =============================================
+void ARISR_scanner_reset(ARISR_SCANNER *scanner)
+{
+    if (!scanner) {
+        return;
+    }
+
+    scanner->match = 0;
+    scanner->frames = 0;
+    scanner->resyncs = 0;
+    ARISR_scanner_clear(scanner);
+}
+
+// =============================================
+ARISR_ERR ARISR_scanner_push(ARISR_SCANNER *scanner, const ARISR_UINT8 *data, ARISR_UINT32 length, ARISR_SCANNER_CB callback, void *user)
+{
+    ARISR_UINT32 pos = 0, take, size;
+    ARISR_UINT8 header_ok;
+    ARISR_ERR err;
+
+    if (!scanner || (!data && length > 0) || !callback) {
+        return kARISR_ERR_GENERIC;
+    }
+
+    for (;;) {
+        /* ===== CANDIDATE IN THE WINDOW ===== */
+        while (scanner->end > scanner->start) {
+            if (scanner->end - scanner->start < scanner->need) {
+                if (pos == length) {
+                    return kARISR_OK;
+                }
+                take = scanner->need - (scanner->end - scanner->start);
+                take = (take < length - pos) ? take : length - pos;
+                ARISR_scanner_append(scanner, data + pos, take);
+                pos += take;
+                continue;
+            }
+
+            err = ARISR_scanner_check(scanner, scanner->buffer + scanner->start, scanner->end - scanner->start
+                                    , &scanner->header_ok, &scanner->need);
+            if (err == kARISR_OK) {
+                ARISR_scanner_emit(scanner, scanner->need, callback, user);
+            } else if (err != kARISR_ERR_INVALID_LENGTH) {
+                scanner->resyncs++;
+                ARISR_scanner_next_candidate(scanner);
+            }
+        }
+
+        /* ===== HUNTING ===== */
+        // Nothing is copied here: a partial match is only a prefix of the pattern
+        if (!ARISR_scanner_hunt(scanner, data, length, &pos)) {
+            return kARISR_OK;
+        }
+
+        if (pos >= ARISR_SCANNER_PATTERN_SIZE) {
+            // The start is in this chunk: check the frame in place, without copying it
+            header_ok = 0;
+            err = ARISR_scanner_check(scanner, data + pos - ARISR_SCANNER_PATTERN_SIZE, length - pos + ARISR_SCANNER_PATTERN_SIZE
+                                    , &header_ok, &size);
+            if (err == kARISR_OK) {
+                scanner->frames++;
+                callback(user, data + pos - ARISR_SCANNER_PATTERN_SIZE, size);
+                pos += size - ARISR_SCANNER_PATTERN_SIZE;
+                scanner->match = 0;
+                continue;
+            }
+            if (err != kARISR_ERR_INVALID_LENGTH) {
+                scanner->resyncs++;
+                continue;
+            }
+        }
+
+        // The frame continues in the next chunks: assemble it in the window
+        memcpy(scanner->buffer, scanner->pattern, ARISR_SCANNER_PATTERN_SIZE);
+        scanner->start = 0;
+        scanner->end = ARISR_SCANNER_PATTERN_SIZE;
+        scanner->cand_head = 0;
+        scanner->cand_count = 0;
+        scanner->need = ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE;
+        scanner->header_ok = 0;
+    }
+}
+
+/* COPYRIGHT ARIS Alliance */
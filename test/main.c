@@ -66,6 +66,35 @@ void printBuffer(ARISR_CHUNK *buffer);
  */
 int checkBuffer(ARISR_CHUNK *interface, int i);
 
+/**
+ * @brief Bit by bit CRC-16/IBM-3740, used as reference for the optimized engines.
+ *
+ * @param data   Pointer to the input data buffer.
+ * @param length Number of bytes in the data buffer.
+ * @return The computed CRC.
+ */
+ARISR_UINT16 crc16Reference(const ARISR_UINT8 *data, ARISR_UINT32 length);
+
+/**
+ * @brief Frames the scanner is expected to emit, in stream order.
+ */
+typedef struct {
+    const ARISR_UINT8 **frames;
+    const ARISR_UINT32 *lengths;
+    ARISR_UINT32 count;
+    ARISR_UINT32 seen;
+    ARISR_UINT32 errors;
+} SCAN_EXPECT;
+
+/**
+ * @brief Scanner callback comparing every emitted frame with the next expected one.
+ *
+ * @param user   Pointer to the SCAN_EXPECT state.
+ * @param frame  Emitted frame.
+ * @param length Length of the emitted frame.
+ */
+void scanExpect(void *user, const ARISR_UINT8 *frame, ARISR_UINT32 length);
+
 
 
 void printBufferRaw(ARISR_CHUNK_RAW *buffer)
@@ -261,6 +290,34 @@ int checkBuffer(ARISR_CHUNK *interface, int i)
 }
 // =================================================================================================
 
+// =============================================
+ARISR_UINT16 crc16Reference(const ARISR_UINT8 *data, ARISR_UINT32 length)
+{
+    ARISR_UINT16 crc = CRC16_INITIAL_VALUE;
+    ARISR_UINT32 i;
+    int bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (ARISR_UINT16)data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (ARISR_UINT16)((crc << 1) ^ CRC16_POLYNOMIAL) : (ARISR_UINT16)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// =============================================
+void scanExpect(void *user, const ARISR_UINT8 *frame, ARISR_UINT32 length)
+{
+    SCAN_EXPECT *expect = (SCAN_EXPECT *)user;
+
+    if (expect->seen >= expect->count || length != expect->lengths[expect->seen] ||
+        memcmp(frame, expect->frames[expect->seen], length) != 0) {
+        expect->errors++;
+    }
+    expect->seen++;
+}
+
 int main(int argc, char *argv[])
 {
     (void)argc;
@@ -277,6 +334,8 @@ int main(int argc, char *argv[])
     ARISR_CHUNK interface;
     ARISR_UINT8 *raw = NULL;
     ARISR_UINT32 raw_length;
+    ARISR_UINT32 frame_length = 0;
+    const ARISR_UINT8 *ctrl;
 
     // =====================================
 
@@ -533,6 +592,27 @@ int main(int argc, char *argv[])
         LOG_INFO("-");
         LOG_INFO("RAW LENGTH = %d", raw_length);
 
+        // Precomputed size must match the built frame
+        if ((err = ARISR_proto_frame_size(ARISR_RAW_TEST_PACK[i-1].chunk, &frame_length)) != kARISR_OK || frame_length != raw_length) {
+            LOG_ERROR("TEST %zu FAILED FRAME SIZE = %u AND EXPECTED = %u", i, frame_length, raw_length);
+            return -1;
+        }
+
+        // Same frame built into a caller-supplied buffer, first too small then exact
+        memset(raw, 0, raw_length);
+        if ((err = ARISR_proto_build_into(raw, raw_length - 1, &raw_length, ARISR_RAW_TEST_PACK[i-1].chunk, key)) != kARISR_ERR_BUFFER_OVERFLOW ||
+            (err = ARISR_proto_build_into(raw, raw_length, &raw_length, ARISR_RAW_TEST_PACK[i-1].chunk, key)) != kARISR_OK) {
+            LOG_ERROR("TEST %zu FAILED BUILD INTO WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        if (raw_length != ARISR_RAW_TEST_PACK[i-1].expected_length || memcmp(raw, ARISR_RAW_TEST_PACK[i-1].expected_raw, raw_length) != 0) {
+            LOG_ERROR("TEST %zu FAILED BUILD INTO RAW MISMATCH", i);
+            return -1;
+        }
+
+        LOG_INFO("[TEST %zu PASSED] Build into = %d", i, err);
+
         LOG_INFO("-------------------------------------------");
         LOG_INFO("");
         LOG_INFO("-------------------------------------------");
@@ -570,6 +650,1429 @@ int main(int argc, char *argv[])
 
 
 
+    // ========== TEST VIEW AND DECRYPT ==============
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("-------   Start viewing raw data   --------");
+    LOG_INFO("-------------------------------------------");
+
+    for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+        ARISR_FRAME_VIEW view;
+        ARISR_UINT8 *plain = NULL;
+        ARISR_UINT32 plain_length = 0;
+
+        LOG_INFO("  > Test %zu:", i);
+        if ((err = ARISR_proto_view(&view, ARISR_RAW_TEST_UNPACK[i-1].msg, key, id)) != ARISR_RAW_TEST_UNPACK[i-1].expected_recv) {
+            LOG_ERROR("TEST %zu FAILED VIEWING WITH ERROR = %d (%s) AND EXPECTED = %d", i, err, ARISR_ERR_NAMES[err], ARISR_RAW_TEST_UNPACK[i-1].expected_recv);
+            return err;
+        }
+
+        if (err == kARISR_OK) {
+            if (view.length != ARISR_RAW_TEST_UNPACK[i-1].length || view.ctrl.destinations != ARISR_RAW_TEST_UNPACK[i-1].destinations) {
+                LOG_ERROR("TEST %zu FAILED VIEW LAYOUT MISMATCH", i);
+                return -1;
+            }
+
+            if ((err = ARISR_proto_view_decrypt(&view, key, &plain, &plain_length)) != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) {
+                LOG_ERROR("TEST %zu FAILED VIEW DECRYPT WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return err;
+            }
+
+            if (err == kARISR_OK && (plain_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                (plain_length > 0 && memcmp(plain, ARISR_RAW_TEST_UNPACK[i-1].data_plain, plain_length) != 0))) {
+                LOG_ERROR("TEST %zu FAILED VIEW DATA MISMATCH", i);
+                return -1;
+            }
+            free(plain);
+
+            // Same data without the heap, into a separate buffer and over a copy of the frame itself
+            if (err == kARISR_OK && view.ctrl2.data_length > 0) {
+                ARISR_UINT8 plain_buffer[ARISR_PROTO_MAX_DATA_LENGTH];
+                ARISR_UINT8 frame_copy[ARISR_PROTO_MAX_FRAME_SIZE];
+
+                if ((err = ARISR_proto_view_decrypt_into(&view, key, plain_buffer, sizeof(plain_buffer), &plain_length)) != kARISR_OK ||
+                    plain_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                    memcmp(plain_buffer, ARISR_RAW_TEST_UNPACK[i-1].data_plain, plain_length) != 0) {
+                    LOG_ERROR("TEST %zu FAILED VIEW DECRYPT INTO, ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                    return -1;
+                }
+
+                if ((err = ARISR_proto_view_decrypt_into(&view, key, plain_buffer, plain_length - 1, &plain_length)) != kARISR_ERR_BUFFER_OVERFLOW) {
+                    LOG_ERROR("TEST %zu FAILED VIEW DECRYPT INTO CAPACITY, ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                    return -1;
+                }
+
+                memcpy(frame_copy, ARISR_RAW_TEST_UNPACK[i-1].msg, view.length);
+                if ((err = ARISR_aes_data_decrypt_inplace(key, frame_copy + view.data_offset, view.ctrl2.data_length, &plain_length)) != kARISR_OK ||
+                    plain_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                    memcmp(frame_copy + view.data_offset, ARISR_RAW_TEST_UNPACK[i-1].data_plain, plain_length) != 0) {
+                    LOG_ERROR("TEST %zu FAILED DECRYPT IN PLACE, ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                    return -1;
+                }
+                err = kARISR_OK;
+            }
+        }
+
+        LOG_INFO("[TEST %zu PASSED] View = %d", i, err);
+
+        // Length-bounded variants must agree with the unbounded ones and reject any other length
+        if ((err = ARISR_proto_view_len(&view, ARISR_RAW_TEST_UNPACK[i-1].msg, ARISR_RAW_TEST_UNPACK[i-1].length, key, id)) != ARISR_RAW_TEST_UNPACK[i-1].expected_recv) {
+            LOG_ERROR("TEST %zu FAILED VIEWING WITH LENGTH, ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return err;
+        }
+
+        if ((err = ARISR_proto_parse_len(&interface, ARISR_RAW_TEST_UNPACK[i-1].msg, ARISR_RAW_TEST_UNPACK[i-1].length - 1, key, id)) != kARISR_ERR_INVALID_LENGTH ||
+            (err = ARISR_proto_recv_len(&buffer, ARISR_RAW_TEST_UNPACK[i-1].msg, ARISR_RAW_TEST_UNPACK[i-1].length + 1, key, id)) != kARISR_ERR_INVALID_LENGTH) {
+            LOG_ERROR("TEST %zu FAILED LENGTH CHECK WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        LOG_INFO("[TEST %zu PASSED] Length = %d", i, err);
+
+        // Frame size predicted from the raw control sections
+        ctrl = ARISR_RAW_TEST_UNPACK[i-1].msg + ARISR_PROTO_CRYPT_SIZE;
+        if ((err = ARISR_proto_header_size_raw(ctrl, &frame_length)) != kARISR_OK ||
+            (err = ARISR_proto_frame_size_raw(ctrl, ARISR_RAW_TEST_UNPACK[i-1].msg + frame_length - ARISR_CTRL2_SECTION_SIZE, &frame_length)) != kARISR_OK ||
+            frame_length != ARISR_RAW_TEST_UNPACK[i-1].length) {
+            LOG_ERROR("TEST %zu FAILED RAW FRAME SIZE = %u AND EXPECTED = %u", i, frame_length, ARISR_RAW_TEST_UNPACK[i-1].length);
+            return -1;
+        }
+
+        LOG_INFO("[TEST %zu PASSED] Frame size = %u", i, frame_length);
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start pre-expanded key ctx --------");
+    LOG_INFO("-------------------------------------------");
+
+    // Key expanded once and reused by every frame below
+    ARISR_KEY_CTX key_ctx;
+    if ((err = ARISR_aes_key_ctx_init(&key_ctx, key)) != kARISR_OK) {
+        LOG_ERROR("TEST FAILED KEY CTX INIT WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+        return err;
+    }
+
+    for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+        LOG_INFO("  > Test %zu:", i);
+        if ((err = ARISR_proto_parse_ctx(&interface, ARISR_RAW_TEST_UNPACK[i-1].msg, &key_ctx, id)) != ARISR_RAW_TEST_UNPACK[i-1].expected_recv && err != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) {
+            LOG_ERROR("TEST %zu FAILED PARSING CTX WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return err;
+        }
+
+        if (err == kARISR_OK && (interface.ctrl2.data_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+            (interface.ctrl2.data_length > 0 && memcmp(interface.data, ARISR_RAW_TEST_UNPACK[i-1].data_plain, interface.ctrl2.data_length) != 0))) {
+            LOG_ERROR("TEST %zu FAILED PARSING CTX DATA MISMATCH", i);
+            return -1;
+        }
+        ARISR_proto_chunk_clean(&interface);
+
+        LOG_INFO("[TEST %zu PASSED] Parse ctx = %d", i, err);
+    }
+
+    for (i = 1; i <= sizeof(ARISR_RAW_TEST_PACK) / sizeof(ARISR_RAW_TEST_PACK[0]); i++) {
+        LOG_INFO("  > Test %zu:", i);
+        if ((err = ARISR_proto_build_ctx(&raw, &raw_length, ARISR_RAW_TEST_PACK[i-1].chunk, &key_ctx)) != kARISR_OK) {
+            LOG_ERROR("TEST %zu FAILED BUILD CTX WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return err;
+        }
+
+        if (raw_length != ARISR_RAW_TEST_PACK[i-1].expected_length || memcmp(raw, ARISR_RAW_TEST_PACK[i-1].expected_raw, raw_length) != 0) {
+            LOG_ERROR("TEST %zu FAILED BUILD CTX RAW MISMATCH", i);
+            free(raw);
+            return -1;
+        }
+        free(raw);
+
+        LOG_INFO("[TEST %zu PASSED] Build ctx = %d", i, err);
+    }
+
+    // A lazy context only expands the key for frames whose payload is decrypted
+    for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+        ARISR_KEY_CTX lazy_ctx;
+
+        ARISR_aes_key_ctx_lazy(&lazy_ctx, key);
+        err = ARISR_proto_parse_ctx(&interface, ARISR_RAW_TEST_UNPACK[i-1].msg, &lazy_ctx, id);
+        if ((err != ARISR_RAW_TEST_UNPACK[i-1].expected_recv && err != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) ||
+            (err == kARISR_OK && (lazy_ctx.key != NULL) != (interface.ctrl2.data_length == 0)) ||
+            (err == kARISR_OK && interface.ctrl2.data_length > 0 &&
+                memcmp(interface.data, ARISR_RAW_TEST_UNPACK[i-1].data_plain, interface.ctrl2.data_length) != 0)) {
+            LOG_ERROR("TEST %zu FAILED LAZY KEY CTX WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        ARISR_proto_chunk_clean(&interface);
+    }
+    LOG_INFO("[TEST PASSED] Lazy key ctx");
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start CTRL decode / encode --------");
+    LOG_INFO("-------------------------------------------");
+
+    // Walk a bit pattern through every field and check it against getField and back
+    for (i = 0; i < 256; i++) {
+        ARISR_UINT8 ctrl_raw[4], ctrl_check[4];
+        ARISR_CHUNK_CTRL ctrl_fields;
+        ARISR_CHUNK_CTRL2 ctrl2_fields;
+        ARISR_UINT32 word = (ARISR_UINT32)i * 0x9E3779B1u;
+
+        word ^= word >> 15;
+        ctrl_raw[0] = (ARISR_UINT8)(word >> 24);
+        ctrl_raw[1] = (ARISR_UINT8)(word >> 16);
+        ctrl_raw[2] = (ARISR_UINT8)(word >>  8);
+        ctrl_raw[3] = (ARISR_UINT8)(word);
+
+        ARISR_proto_ctrl_decode(ctrl_raw, &ctrl_fields);
+        if (ctrl_fields.version      != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_VERSION_MASK, ARISR_CTRL_VERSION_SHIFT)
+         || ctrl_fields.destinations != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_DESTS_MASK, ARISR_CTRL_DESTS_SHIFT)
+         || ctrl_fields.option       != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_OPTION_MASK, ARISR_CTRL_OPTION_SHIFT)
+         || ctrl_fields.from         != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_FROM_MASK, ARISR_CTRL_FROM_SHIFT)
+         || ctrl_fields.sequence     != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_SEQUENCE_MASK, ARISR_CTRL_SEQUENCE_SHIFT)
+         || ctrl_fields.retry        != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_RETRY_MASK, ARISR_CTRL_RETRY_SHIFT)
+         || ctrl_fields.more_data    != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_MD_MASK, ARISR_CTRL_MD_SHIFT)
+         || ctrl_fields.identifier   != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_ID_MASK, ARISR_CTRL_ID_SHIFT)
+         || ctrl_fields.more_header  != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL_MH_MASK, ARISR_CTRL_MH_SHIFT)) {
+            LOG_ERROR("TEST %u FAILED CTRL DECODE MISMATCH", i);
+            return -1;
+        }
+
+        ARISR_proto_ctrl_encode(ctrl_check, &ctrl_fields);
+        if (memcmp(ctrl_check, ctrl_raw, sizeof(ctrl_raw)) != 0) {
+            LOG_ERROR("TEST %u FAILED CTRL ENCODE MISMATCH", i);
+            return -1;
+        }
+
+        ARISR_proto_ctrl2_decode(ctrl_raw, &ctrl2_fields);
+        if (ctrl2_fields.data_length != (ARISR_UINT32)ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL2_DATA_LENGTH_MASK, ARISR_CTRL2_DATA_LENGTH_SHIFT) * ARISR_DATA_MULT
+         || ctrl2_fields.feature     != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL2_FEATURE_MASK, ARISR_CTRL2_FEATURE_SHIFT)
+         || ctrl2_fields.neg_answer  != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL2_NEG_ANSWER_MASK, ARISR_CTRL2_NEG_ANSWER_SHIFT)
+         || ctrl2_fields.freq_switch != ARISR_proto_ctrl_getField(ctrl_raw, ARISR_CTRL2_FREQ_SWITCH_MASK, ARISR_CTRL2_FREQ_SWITCH_SHIFT)) {
+            LOG_ERROR("TEST %u FAILED CTRL2 DECODE MISMATCH", i);
+            return -1;
+        }
+
+        // CTRL2 has unused bits, only the defined fields must survive
+        ARISR_proto_ctrl2_encode(ctrl_check, &ctrl2_fields);
+        word = ARISR_CTRL2_DATA_LENGTH_MASK | ARISR_CTRL2_FEATURE_MASK | ARISR_CTRL2_NEG_ANSWER_MASK | ARISR_CTRL2_FREQ_SWITCH_MASK;
+        if (ctrl_check[0] != (ctrl_raw[0] & (ARISR_UINT8)(word >> 24)) || ctrl_check[1] != (ctrl_raw[1] & (ARISR_UINT8)(word >> 16))
+         || ctrl_check[2] != (ctrl_raw[2] & (ARISR_UINT8)(word >> 8))  || ctrl_check[3] != (ctrl_raw[3] & (ARISR_UINT8)word)) {
+            LOG_ERROR("TEST %u FAILED CTRL2 ENCODE MISMATCH", i);
+            return -1;
+        }
+    }
+    LOG_INFO("[TEST PASSED] CTRL decode / encode round trip");
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start arena allocator -------------");
+    LOG_INFO("-------------------------------------------");
+
+    // Every variable-size field of a whole batch comes from one arena, released by one reset
+    {
+        ARISR_ARENA arena;
+        ARISR_ALLOCATOR arena_allocator;
+        ARISR_CHUNK arena_chunks[sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0])];
+        ARISR_UINT8 tiny_memory[8];
+
+        if ((err = ARISR_arena_create(&arena, ARISR_ARENA_CHUNK_SIZE * 2)) != kARISR_OK ||
+            (err = ARISR_arena_allocator(&arena_allocator, &arena)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED ARENA CREATE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+            if ((err = ARISR_proto_parse_ctx_alloc(&arena_chunks[i-1], ARISR_RAW_TEST_UNPACK[i-1].msg, &key_ctx, id, &arena_allocator)) != ARISR_RAW_TEST_UNPACK[i-1].expected_recv && err != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) {
+                LOG_ERROR("TEST %zu FAILED ARENA PARSE WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+            if (err == kARISR_OK && (arena_chunks[i-1].ctrl2.data_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                (arena_chunks[i-1].data && memcmp(arena_chunks[i-1].data, ARISR_RAW_TEST_UNPACK[i-1].data_plain, arena_chunks[i-1].ctrl2.data_length) != 0))) {
+                LOG_ERROR("TEST %zu FAILED ARENA PARSE DATA MISMATCH", i);
+                return -1;
+            }
+            if (arena_chunks[i-1].data && ((ARISR_UINT8 *)arena_chunks[i-1].data < arena.memory || (ARISR_UINT8 *)arena_chunks[i-1].data >= arena.memory + arena.capacity)) {
+                LOG_ERROR("TEST %zu FAILED ARENA PARSE DATA OUTSIDE THE ARENA", i);
+                return -1;
+            }
+        }
+
+        // Frees are no-ops, the batch goes back in one reset
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+            ARISR_proto_chunk_clean_alloc(&arena_chunks[i-1], &arena_allocator);
+        }
+        if (arena.used == 0) {
+            LOG_ERROR("TEST FAILED ARENA NOT USED");
+            return -1;
+        }
+        ARISR_arena_reset(&arena);
+        LOG_INFO("[TEST PASSED] Arena parse batch");
+
+        // Pack, send, receive and unpack round trip through the arena
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_PACK) / sizeof(ARISR_RAW_TEST_PACK[0]); i++) {
+            const ARISR_CHUNK *chunk = ARISR_RAW_TEST_PACK[i-1].chunk;
+
+            memset(&buffer, 0, sizeof(buffer));
+            if ((err = ARISR_proto_pack_alloc(&buffer, (ARISR_CHUNK *)chunk, key, &arena_allocator)) != kARISR_OK ||
+                (err = ARISR_proto_send(&raw, &buffer, &raw_length)) != kARISR_OK) {
+                LOG_ERROR("TEST %zu FAILED ARENA PACK WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+            if (raw_length != ARISR_RAW_TEST_PACK[i-1].expected_length || memcmp(raw, ARISR_RAW_TEST_PACK[i-1].expected_raw, raw_length) != 0) {
+                LOG_ERROR("TEST %zu FAILED ARENA PACK RAW MISMATCH", i);
+                return -1;
+            }
+            ARISR_proto_raw_chunk_clean_alloc(&buffer, &arena_allocator);
+
+            if ((err = ARISR_proto_recv_alloc(&buffer, raw, key, id, &arena_allocator)) != kARISR_OK ||
+                (err = ARISR_proto_unpack_alloc(&interface, &buffer, key, &arena_allocator)) != kARISR_OK) {
+                LOG_ERROR("TEST %zu FAILED ARENA RECV / UNPACK WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+            free(raw);
+
+            if (interface.ctrl2.data_length != chunk->ctrl2.data_length ||
+                (chunk->ctrl2.data_length > 0 && memcmp(interface.data, chunk->data, chunk->ctrl2.data_length) != 0)) {
+                LOG_ERROR("TEST %zu FAILED ARENA UNPACK DATA MISMATCH", i);
+                return -1;
+            }
+            ARISR_proto_raw_chunk_clean_alloc(&buffer, &arena_allocator);
+            ARISR_proto_chunk_clean_alloc(&interface, &arena_allocator);
+            ARISR_arena_reset(&arena);
+
+            LOG_INFO("[TEST %zu PASSED] Arena pack / unpack", i);
+        }
+        ARISR_arena_destroy(&arena);
+
+        // An exhausted arena is reported as an allocation failure
+        ARISR_arena_init(&arena, tiny_memory, sizeof(tiny_memory));
+        ARISR_arena_allocator(&arena_allocator, &arena);
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+            if (ARISR_RAW_TEST_UNPACK[i-1].expected_recv == kARISR_OK && ARISR_RAW_TEST_UNPACK[i-1].data_length > 0) {
+                if ((err = ARISR_proto_parse_ctx_alloc(&arena_chunks[0], ARISR_RAW_TEST_UNPACK[i-1].msg, &key_ctx, id, &arena_allocator)) != kARISR_ERR_GENERIC) {
+                    LOG_ERROR("TEST %zu FAILED ARENA EXHAUSTION WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                    return -1;
+                }
+                break;
+            }
+        }
+        LOG_INFO("[TEST PASSED] Arena exhaustion");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start fixed-capacity chunk --------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_CHUNK_STATIC static_chunk;
+        static ARISR_UINT8 static_frame[ARISR_PROTO_MAX_FRAME_SIZE];
+        ARISR_UINT32 static_length;
+
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]); i++) {
+            if ((err = ARISR_proto_parse_len_static(&static_chunk, ARISR_RAW_TEST_UNPACK[i-1].msg, ARISR_RAW_TEST_UNPACK[i-1].length, key, id)) != ARISR_RAW_TEST_UNPACK[i-1].expected_recv && err != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) {
+                LOG_ERROR("TEST %zu FAILED STATIC PARSE WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+            if (err != kARISR_OK) {
+                continue;
+            }
+
+            if (static_chunk.ctrl.destinations != ARISR_RAW_TEST_UNPACK[i-1].destinations ||
+                static_chunk.ctrl2.data_length != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                memcmp(static_chunk.data, ARISR_RAW_TEST_UNPACK[i-1].data_plain, static_chunk.ctrl2.data_length) != 0) {
+                LOG_ERROR("TEST %zu FAILED STATIC PARSE MISMATCH", i);
+                return -1;
+            }
+
+            LOG_INFO("[TEST %zu PASSED] Static parse", i);
+        }
+
+        // Same frames as ARISR_proto_build from the inline layout, and parsed back
+        for (i = 1; i <= sizeof(ARISR_RAW_TEST_PACK) / sizeof(ARISR_RAW_TEST_PACK[0]); i++) {
+            const ARISR_CHUNK *chunk = ARISR_RAW_TEST_PACK[i-1].chunk;
+
+            memset(&static_chunk, 0, sizeof(static_chunk));
+            memcpy(static_chunk.id, chunk->id, ARISR_PROTO_ID_SIZE);
+            memcpy(static_chunk.aris, chunk->aris, ARISR_PROTO_ARIS_SIZE);
+            static_chunk.ctrl = chunk->ctrl;
+            memcpy(static_chunk.origin, chunk->origin, ARISR_ADDRESS_SIZE);
+            memcpy(static_chunk.destinationA, chunk->destinationA, ARISR_ADDRESS_SIZE);
+            if (chunk->ctrl.destinations > 0) {
+                memcpy(static_chunk.destinationsB, chunk->destinationsB, chunk->ctrl.destinations * ARISR_ADDRESS_SIZE);
+            }
+            memcpy(static_chunk.destinationC, chunk->destinationC, ARISR_ADDRESS_SIZE);
+            static_chunk.ctrl2 = chunk->ctrl2;
+            if (chunk->ctrl2.data_length > 0) {
+                memcpy(static_chunk.data, chunk->data, chunk->ctrl2.data_length);
+            }
+
+            if ((err = ARISR_proto_build_static_ctx(static_frame, sizeof(static_frame), &static_length, &static_chunk, &key_ctx)) != kARISR_OK ||
+                static_length != ARISR_RAW_TEST_PACK[i-1].expected_length ||
+                memcmp(static_frame, ARISR_RAW_TEST_PACK[i-1].expected_raw, static_length) != 0) {
+                LOG_ERROR("TEST %zu FAILED STATIC BUILD WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            memset(&static_chunk, 0xA5, sizeof(static_chunk));
+            if ((err = ARISR_proto_parse_static_ctx(&static_chunk, static_frame, &key_ctx, id)) != kARISR_OK ||
+                static_chunk.ctrl2.data_length != chunk->ctrl2.data_length ||
+                (chunk->ctrl2.data_length > 0 && memcmp(static_chunk.data, chunk->data, chunk->ctrl2.data_length) != 0) ||
+                (chunk->ctrl.destinations > 0 && memcmp(static_chunk.destinationsB, chunk->destinationsB, chunk->ctrl.destinations * ARISR_ADDRESS_SIZE) != 0)) {
+                LOG_ERROR("TEST %zu FAILED STATIC ROUND TRIP WITH ERROR = %d (%s)", i, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            LOG_INFO("[TEST %zu PASSED] Static build / parse", i);
+        }
+
+        static_chunk.ctrl2.data_length = ARISR_STATIC_MAX_DATA_LENGTH + 1;
+        if ((err = ARISR_proto_build_static(static_frame, sizeof(static_frame), &static_length, &static_chunk, key)) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED STATIC BUILD CAPACITY WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start batch parse -----------------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        enum { BATCH_FRAMES = sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]) };
+        const ARISR_UINT8 *batch_frames[BATCH_FRAMES + 1];
+        ARISR_UINT32 batch_lengths[BATCH_FRAMES + 1];
+        ARISR_BATCH batch;
+        ARISR_UINT32 batch_valid = 0;
+
+        for (i = 1; i <= BATCH_FRAMES; i++) {
+            batch_frames[i-1]  = ARISR_RAW_TEST_UNPACK[i-1].msg;
+            batch_lengths[i-1] = ARISR_RAW_TEST_UNPACK[i-1].length;
+        }
+        // A missing frame only fails its own slot
+        batch_frames[BATCH_FRAMES]  = NULL;
+        batch_lengths[BATCH_FRAMES] = 0;
+
+        if ((err = ARISR_batch_create(&batch, BATCH_FRAMES + 1, (BATCH_FRAMES + 1) * ARISR_PROTO_MAX_DATA_LENGTH, NULL)) != kARISR_OK ||
+            (err = ARISR_proto_parse_batch(batch_frames, batch_lengths, BATCH_FRAMES + 1, &key_ctx, id, &batch)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED BATCH PARSE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        for (i = 1; i <= BATCH_FRAMES; i++) {
+            if (batch.status[i-1] != ARISR_RAW_TEST_UNPACK[i-1].expected_recv && batch.status[i-1] != ARISR_RAW_TEST_UNPACK[i-1].expected_unpack) {
+                LOG_ERROR("TEST %zu FAILED BATCH STATUS = %d (%s)", i, batch.status[i-1], ARISR_ERR_NAMES[batch.status[i-1]]);
+                return -1;
+            }
+            if (batch.status[i-1] != kARISR_OK) {
+                continue;
+            }
+            batch_valid++;
+
+            if (memcmp(batch.origin[i-1], ARISR_RAW_TEST_UNPACK[i-1].msg + ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE, ARISR_ADDRESS_SIZE) != 0 ||
+                batch.destinations[i-1] != ARISR_RAW_TEST_UNPACK[i-1].destinations ||
+                batch.sequence[i-1] != ARISR_RAW_TEST_UNPACK[i-1].sequence ||
+                batch.identifier[i-1] != ARISR_RAW_TEST_UNPACK[i-1].identifier ||
+                batch.payload_length[i-1] != ARISR_RAW_TEST_UNPACK[i-1].data_length ||
+                (batch.payload_length[i-1] > 0 && memcmp(batch.payload + batch.payload_offset[i-1], ARISR_RAW_TEST_UNPACK[i-1].data_plain, batch.payload_length[i-1]) != 0)) {
+                LOG_ERROR("TEST %zu FAILED BATCH COLUMNS MISMATCH", i);
+                return -1;
+            }
+        }
+
+        if (batch.status[BATCH_FRAMES] != kARISR_ERR_GENERIC || batch.valid != batch_valid || batch.count != BATCH_FRAMES + 1) {
+            LOG_ERROR("TEST FAILED BATCH SUMMARY valid = %u", batch.valid);
+            return -1;
+        }
+        ARISR_batch_destroy(&batch);
+        LOG_INFO("[TEST PASSED] Batch parse of %u frames, %u valid", (unsigned)(BATCH_FRAMES + 1), batch_valid);
+
+        // Payload space for nothing: frames with data overflow, header-only frames still pass
+        if ((err = ARISR_batch_create(&batch, BATCH_FRAMES, 0, NULL)) != kARISR_OK ||
+            (err = ARISR_proto_parse_batch(batch_frames, batch_lengths, BATCH_FRAMES, &key_ctx, id, &batch)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED BATCH PARSE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        for (i = 1; i <= BATCH_FRAMES; i++) {
+            if (ARISR_RAW_TEST_UNPACK[i-1].expected_recv == kARISR_OK && ARISR_RAW_TEST_UNPACK[i-1].expected_unpack == kARISR_OK &&
+                batch.status[i-1] != (ARISR_RAW_TEST_UNPACK[i-1].data_length > 0 ? kARISR_ERR_BUFFER_OVERFLOW : kARISR_OK)) {
+                LOG_ERROR("TEST %zu FAILED BATCH PAYLOAD CAPACITY STATUS = %d (%s)", i, batch.status[i-1], ARISR_ERR_NAMES[batch.status[i-1]]);
+                return -1;
+            }
+        }
+        if (ARISR_proto_parse_batch(batch_frames, batch_lengths, BATCH_FRAMES + 1, &key_ctx, id, &batch) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED BATCH CAPACITY CHECK");
+            return -1;
+        }
+        ARISR_batch_destroy(&batch);
+        LOG_INFO("[TEST PASSED] Batch payload capacity");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+#if ARISR_POOL_THREADS
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start worker pool -----------------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        enum { POOL_VECTORS = sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]), POOL_FRAMES = POOL_VECTORS * 37 };
+        static const ARISR_UINT8 *pool_frames[POOL_FRAMES];
+        static ARISR_UINT32 pool_lengths[POOL_FRAMES];
+        static ARISR_CHUNK pool_results[POOL_FRAMES];
+        static ARISR_CHUNK_RAW pool_raw[POOL_FRAMES];
+        static ARISR_ERR pool_status[POOL_FRAMES];
+        ARISR_CHUNK pool_expected;
+        ARISR_ERR pool_err;
+        ARISR_POOL *pool;
+        int round;
+
+        // Many more tasks than workers, so the deques drain unevenly and get stolen from
+        for (i = 0; i < POOL_FRAMES; i++) {
+            pool_frames[i]  = ARISR_RAW_TEST_UNPACK[i % POOL_VECTORS].msg;
+            pool_lengths[i] = ARISR_RAW_TEST_UNPACK[i % POOL_VECTORS].length;
+        }
+        pool_frames[POOL_FRAMES / 2] = NULL;
+
+        // A tiny arena: most fields spill to the heap
+        if ((err = ARISR_pool_create(&pool, 4, key, 64)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED POOL CREATE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        for (round = 0; round < 2; round++) {
+            if ((err = ARISR_pool_parse(pool, pool_frames, pool_lengths, POOL_FRAMES, id, pool_results, pool_status)) != kARISR_OK) {
+                LOG_ERROR("TEST FAILED POOL PARSE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            // Every slot must match a sequential parse of the same frame
+            for (i = 0; i < POOL_FRAMES; i++) {
+                pool_err = pool_frames[i] ? ARISR_proto_parse_len_ctx(&pool_expected, pool_frames[i], pool_lengths[i], &key_ctx, id) : kARISR_ERR_GENERIC;
+
+                if (pool_status[i] != pool_err) {
+                    LOG_ERROR("TEST %zu FAILED POOL STATUS = %d (%s)", i, pool_status[i], ARISR_ERR_NAMES[pool_status[i]]);
+                    return -1;
+                }
+                if (pool_err != kARISR_OK) {
+                    continue;
+                }
+
+                if (memcmp(pool_results[i].origin, pool_expected.origin, ARISR_ADDRESS_SIZE) != 0 ||
+                    pool_results[i].ctrl.sequence != pool_expected.ctrl.sequence ||
+                    pool_results[i].ctrl.destinations != pool_expected.ctrl.destinations ||
+                    pool_results[i].ctrl2.data_length != pool_expected.ctrl2.data_length ||
+                    (pool_expected.ctrl.destinations > 0 &&
+                        memcmp(pool_results[i].destinationsB, pool_expected.destinationsB, pool_expected.ctrl.destinations * ARISR_ADDRESS_SIZE) != 0) ||
+                    (pool_expected.data && memcmp(pool_results[i].data, pool_expected.data, pool_expected.ctrl2.data_length) != 0)) {
+                    LOG_ERROR("TEST %zu FAILED POOL RESULT MISMATCH", i);
+                    return -1;
+                }
+                ARISR_proto_chunk_clean(&pool_expected);
+            }
+        }
+        LOG_INFO("[TEST PASSED] Pool parse of %u frames on 4 workers, in input order", (unsigned)POOL_FRAMES);
+
+        if ((err = ARISR_pool_recv(pool, pool_frames, pool_lengths, POOL_FRAMES, id, pool_raw, pool_status)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED POOL RECV WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        for (i = 0; i < POOL_FRAMES; i++) {
+            if (pool_frames[i] && pool_status[i] != ARISR_RAW_TEST_UNPACK[i % POOL_VECTORS].expected_recv) {
+                LOG_ERROR("TEST %zu FAILED POOL RECV STATUS = %d (%s)", i, pool_status[i], ARISR_ERR_NAMES[pool_status[i]]);
+                return -1;
+            }
+        }
+        ARISR_pool_destroy(pool);
+        LOG_INFO("[TEST PASSED] Pool recv of %u frames", (unsigned)POOL_FRAMES);
+
+        if (ARISR_pool_create(&pool, 0, key, 64) != kARISR_ERR_INVALID_ARGUMENT ||
+            ARISR_pool_create(&pool, ARISR_POOL_MAX_WORKERS + 1, key, 64) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED POOL ARGUMENT CHECK");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Pool arguments");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+#endif // ARISR_POOL_THREADS
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start stream scanner --------------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        enum { SCAN_VECTORS = sizeof(ARISR_RAW_TEST_UNPACK) / sizeof(ARISR_RAW_TEST_UNPACK[0]) };
+        static ARISR_UINT8 scan_stream[SCAN_VECTORS * 3 * ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_SCANNER scanner;
+        const ARISR_UINT8 *scan_frames[SCAN_VECTORS];
+        ARISR_UINT32 scan_lengths[SCAN_VECTORS];
+        const ARISR_UINT32 scan_steps[] = { 1, 3, 7, 64, 1000, sizeof(scan_stream) };
+        ARISR_UINT32 scan_size = 0, scan_count = 0, scan_pos, scan_take, step;
+        ARISR_FRAME_VIEW scan_view;
+        SCAN_EXPECT expect;
+
+        // Noise, then every valid frame preceded by a cut copy of itself and followed by a corrupted copy
+        memset(scan_stream, 0x5A, 13);
+        scan_size = 13;
+        for (i = 0; i < SCAN_VECTORS; i++) {
+            if (ARISR_proto_view_len_ctx(&scan_view, ARISR_RAW_TEST_UNPACK[i].msg, ARISR_RAW_TEST_UNPACK[i].length, &key_ctx, id) != kARISR_OK) {
+                continue;
+            }
+
+            memcpy(scan_stream + scan_size, ARISR_RAW_TEST_UNPACK[i].msg, 20);
+            scan_size += 20;
+
+            memcpy(scan_stream + scan_size, ARISR_RAW_TEST_UNPACK[i].msg, ARISR_RAW_TEST_UNPACK[i].length);
+            scan_frames[scan_count] = ARISR_RAW_TEST_UNPACK[i].msg;
+            scan_lengths[scan_count++] = ARISR_RAW_TEST_UNPACK[i].length;
+            scan_size += ARISR_RAW_TEST_UNPACK[i].length;
+
+            memcpy(scan_stream + scan_size, ARISR_RAW_TEST_UNPACK[i].msg, ARISR_RAW_TEST_UNPACK[i].length);
+            scan_stream[scan_size + ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE] ^= 0xFF;
+            scan_size += ARISR_RAW_TEST_UNPACK[i].length;
+
+            // A lone network ID, which is also how every frame ends
+            memcpy(scan_stream + scan_size, id, ARISR_PROTO_ID_SIZE);
+            scan_size += ARISR_PROTO_ID_SIZE;
+        }
+
+        if (scan_count == 0 || ARISR_scanner_init(&scanner, &key_ctx, id) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED SCANNER INIT");
+            return -1;
+        }
+
+        for (step = 0; step < sizeof(scan_steps) / sizeof(scan_steps[0]); step++) {
+            memset(&expect, 0, sizeof(expect));
+            expect.frames = scan_frames;
+            expect.lengths = scan_lengths;
+            expect.count = scan_count;
+            ARISR_scanner_reset(&scanner);
+
+            for (scan_pos = 0; scan_pos < scan_size; scan_pos += scan_take) {
+                scan_take = (scan_size - scan_pos < scan_steps[step]) ? scan_size - scan_pos : scan_steps[step];
+                if ((err = ARISR_scanner_push(&scanner, scan_stream + scan_pos, scan_take, scanExpect, &expect)) != kARISR_OK) {
+                    LOG_ERROR("TEST FAILED SCANNER PUSH WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+                    return -1;
+                }
+            }
+
+            if (expect.errors != 0 || expect.seen != scan_count || scanner.frames != scan_count || scanner.resyncs < 2 * scan_count) {
+                LOG_ERROR("TEST FAILED SCANNER CHUNKS OF %u: %u/%u frames, %u errors, %u resyncs",
+                    scan_steps[step], expect.seen, scan_count, expect.errors, scanner.resyncs);
+                return -1;
+            }
+        }
+        LOG_INFO("[TEST PASSED] Scanner found %u frames in %u bytes with chunks from 1 byte to the whole stream", scan_count, scan_size);
+
+        // Planted starts at every alignment, against a byte by byte search. Near misses share the first ID and ARIS bytes
+        {
+            ARISR_UINT32 find_at, find_length, find_pos, found, expected;
+
+            for (find_length = 0; find_length <= 80; find_length++) {
+                for (find_at = 0; find_at <= find_length; find_at++) {
+                    for (find_pos = 0; find_pos < find_length; find_pos++) {
+                        scan_stream[find_pos] = (find_pos % 5 == 0) ? scanner.pattern[0] : (find_pos % 5 == 4) ? scanner.pattern[ARISR_PROTO_ID_SIZE] : (ARISR_UINT8)(find_pos * 37);
+                    }
+                    if (find_at + ARISR_SCANNER_PATTERN_SIZE <= find_length) {
+                        memcpy(scan_stream + find_at, scanner.pattern, ARISR_SCANNER_PATTERN_SIZE);
+                    }
+
+                    expected = find_length;
+                    for (find_pos = 0; find_pos + ARISR_SCANNER_PATTERN_SIZE <= find_length; find_pos++) {
+                        if (memcmp(scan_stream + find_pos, scanner.pattern, ARISR_SCANNER_PATTERN_SIZE) == 0) {
+                            expected = find_pos;
+                            break;
+                        }
+                    }
+
+                    if ((found = ARISR_scanner_find(&scanner, scan_stream, find_length)) != expected) {
+                        LOG_ERROR("TEST FAILED SCANNER FIND AT %u OF %u: %u, expected %u", find_at, find_length, found, expected);
+                        return -1;
+                    }
+                }
+            }
+        }
+        LOG_INFO("[TEST PASSED] Scanner frame start search");
+
+        if (ARISR_scanner_init(NULL, &key_ctx, id) != kARISR_ERR_INVALID_ARGUMENT ||
+            ARISR_scanner_push(&scanner, scan_stream, 1, NULL, NULL) != kARISR_ERR_GENERIC) {
+            LOG_ERROR("TEST FAILED SCANNER ARGUMENT CHECK");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Scanner arguments");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start fragment reassembly ---------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 reasm_payload[5 * 100];
+        static ARISR_UINT8 reasm_output[5 * 100];
+        const ARISR_UINT8 reasm_order[] = { 3, 0, 4, 0, 1, 2 };      // Out of order, with a duplicate
+        ARISR_REASM reasm;
+        ARISR_REASM_MESSAGE message, other;
+        ARISR_CHUNK fragment;
+        ARISR_UINT32 n;
+
+        for (n = 0; n < sizeof(reasm_payload); n++) {
+            reasm_payload[n] = (ARISR_UINT8)(n * 7 + 1);
+        }
+
+        if ((err = ARISR_reasm_create(&reasm, 2, 8, 100, 50, NULL)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED REASM CREATE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // A single frame is handed back in place
+        memset(&fragment, 0, sizeof(fragment));
+        memset(fragment.origin, 0xA1, ARISR_ADDRESS_SIZE);
+        fragment.ctrl.identifier = 9;
+        fragment.ctrl2.data_length = 10;
+        fragment.data = reasm_payload;
+        if (ARISR_reasm_push(&reasm, &fragment, 0, &message) != kARISR_OK || message.count != 1 ||
+            message.iov[0].base != reasm_payload || message.length != 10) {
+            LOG_ERROR("TEST FAILED REASM SINGLE FRAME");
+            return -1;
+        }
+        ARISR_reasm_release(&reasm, &message);
+        LOG_INFO("[TEST PASSED] Reassembly of a single frame without copy");
+
+        // Five fragments of 100, 100, 100, 100 and 60 bytes, interleaved with another origin using the same identifier
+        for (n = 0; n < sizeof(reasm_order); n++) {
+            fragment.ctrl.sequence = reasm_order[n];
+            fragment.ctrl.more_data = reasm_order[n] != 4;
+            fragment.ctrl2.data_length = reasm_order[n] == 4 ? 60 : 100;
+            fragment.data = reasm_payload + reasm_order[n] * 100;
+
+            if ((err = ARISR_reasm_push(&reasm, &fragment, 10 + n, &message)) != kARISR_OK) {
+                LOG_ERROR("TEST FAILED REASM PUSH WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+            if (n == 1) {
+                memset(fragment.origin, 0xB2, ARISR_ADDRESS_SIZE);
+                fragment.ctrl.sequence = 0;
+                fragment.ctrl.more_data = 1;
+                if (ARISR_reasm_push(&reasm, &fragment, 10 + n, &other) != kARISR_OK || other.count != 0) {
+                    LOG_ERROR("TEST FAILED REASM SECOND ORIGIN");
+                    return -1;
+                }
+                memset(fragment.origin, 0xA1, ARISR_ADDRESS_SIZE);
+            }
+            if ((message.count != 0) != (n == sizeof(reasm_order) - 1)) {
+                LOG_ERROR("TEST %u FAILED REASM COMPLETION count = %u", n, message.count);
+                return -1;
+            }
+        }
+
+        if (message.count != 5 || message.length != 460 || message.identifier != 9 || reasm.duplicates != 1 ||
+            ARISR_reasm_copy(&message, reasm_output, sizeof(reasm_output)) != kARISR_OK ||
+            memcmp(reasm_output, reasm_payload, 460) != 0 ||
+            ARISR_reasm_copy(&message, reasm_output, 459) != kARISR_ERR_BUFFER_OVERFLOW) {
+            LOG_ERROR("TEST FAILED REASM MESSAGE MISMATCH");
+            return -1;
+        }
+        ARISR_reasm_release(&reasm, &message);
+        LOG_INFO("[TEST PASSED] Reassembly of 5 fragments out of order");
+
+        // The message of the second origin times out, its slab comes back
+        memset(fragment.origin, 0xC3, ARISR_ADDRESS_SIZE);
+        fragment.ctrl.sequence = 1;
+        fragment.ctrl.more_data = 1;
+        if (ARISR_reasm_push(&reasm, &fragment, 100, &message) != kARISR_OK || reasm.evicted != 1 ||
+            reasm.free_slab_count != 7 || reasm.free_entry_count != 1) {
+            LOG_ERROR("TEST FAILED REASM TIMEOUT evicted = %u", reasm.evicted);
+            return -1;
+        }
+
+        // Out of entries: the oldest message makes room
+        memset(fragment.origin, 0xD4, ARISR_ADDRESS_SIZE);
+        ARISR_reasm_push(&reasm, &fragment, 101, &message);
+        memset(fragment.origin, 0xE5, ARISR_ADDRESS_SIZE);
+        if (ARISR_reasm_push(&reasm, &fragment, 102, &message) != kARISR_OK || reasm.evicted != 2) {
+            LOG_ERROR("TEST FAILED REASM EVICTION evicted = %u", reasm.evicted);
+            return -1;
+        }
+
+        fragment.ctrl2.data_length = 101;
+        if (ARISR_reasm_push(&reasm, &fragment, 103, &message) != kARISR_ERR_BUFFER_OVERFLOW) {
+            LOG_ERROR("TEST FAILED REASM SLAB SIZE CHECK");
+            return -1;
+        }
+
+        // The highest sequence takes the top bit of 'received', a second copy is a duplicate
+        fragment.ctrl2.data_length = 10;
+        fragment.ctrl.sequence = ARISR_REASM_MAX_FRAGMENTS - 1;
+        fragment.ctrl.more_data = 0;
+        if (ARISR_reasm_push(&reasm, &fragment, 104, &message) != kARISR_OK || message.count != 0 ||
+            ARISR_reasm_push(&reasm, &fragment, 105, &message) != kARISR_OK || reasm.duplicates != 2) {
+            LOG_ERROR("TEST FAILED REASM LAST SEQUENCE duplicates = %u", reasm.duplicates);
+            return -1;
+        }
+
+        ARISR_reasm_expire(&reasm, 1000);
+        if (reasm.free_slab_count != reasm.slab_count || reasm.free_entry_count != reasm.max_messages || reasm.completed != 2) {
+            LOG_ERROR("TEST FAILED REASM LEAK slabs = %u entries = %u", reasm.free_slab_count, reasm.free_entry_count);
+            return -1;
+        }
+        ARISR_reasm_destroy(&reasm);
+        LOG_INFO("[TEST PASSED] Reassembly timeout and eviction");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start fragment building -----------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 frag_payload[5000];
+        static ARISR_UINT8 frag_frames[3 * ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 frag_output[5000];
+        ARISR_UINT32 frag_offsets[ARISR_PROTO_MAX_FRAGMENTS + 1];
+        ARISR_UINT32 frag_count, n;
+        ARISR_CHUNK header, parsed;
+        ARISR_REASM reasm;
+        ARISR_REASM_MESSAGE message;
+
+        for (n = 0; n < sizeof(frag_payload); n++) {
+            frag_payload[n] = (ARISR_UINT8)(n * 13 + 5);
+        }
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.id, id, ARISR_PROTO_ID_SIZE);
+        memcpy(header.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+        memset(header.origin, 0xB2, ARISR_ADDRESS_SIZE);
+        memset(header.destinationA, 0xC3, ARISR_ADDRESS_SIZE);
+        header.ctrl.identifier = 5;
+
+        if ((err = ARISR_proto_build_fragments(frag_frames, sizeof(frag_frames), &header, frag_payload, sizeof(frag_payload),
+                                               ARISR_PROTO_MAX_FRAGMENT_SIZE, frag_offsets, ARISR_PROTO_MAX_FRAGMENTS, &frag_count, key)) != kARISR_OK ||
+            frag_count != 3) {
+            LOG_ERROR("TEST FAILED BUILD FRAGMENTS WITH ERROR = %d (%s) count = %u", err, ARISR_ERR_NAMES[err], frag_count);
+            return -1;
+        }
+
+        if ((err = ARISR_reasm_create(&reasm, 1, 4, ARISR_PROTO_MAX_FRAGMENT_SIZE, 0, NULL)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED REASM CREATE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // Parse the fragments last first, the reassembler puts them back in order
+        for (n = frag_count; n-- > 0;) {
+            if ((err = ARISR_proto_parse_len(&parsed, frag_frames + frag_offsets[n], frag_offsets[n + 1] - frag_offsets[n], key, id)) != kARISR_OK ||
+                parsed.ctrl.sequence != n || parsed.ctrl.more_data != (n + 1 < frag_count) || parsed.ctrl.identifier != 5) {
+                LOG_ERROR("TEST FAILED PARSE FRAGMENT %u WITH ERROR = %d (%s)", n, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            err = ARISR_reasm_push(&reasm, &parsed, 0, &message);
+            ARISR_proto_chunk_clean(&parsed);
+            if (err != kARISR_OK || (message.count != 0) != (n == 0)) {
+                LOG_ERROR("TEST FAILED REASM FRAGMENT %u WITH ERROR = %d (%s)", n, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+        }
+
+        if (message.length != sizeof(frag_payload) || ARISR_reasm_copy(&message, frag_output, sizeof(frag_output)) != kARISR_OK ||
+            memcmp(frag_output, frag_payload, sizeof(frag_payload)) != 0) {
+            LOG_ERROR("TEST FAILED FRAGMENT ROUND TRIP length = %u", message.length);
+            return -1;
+        }
+        ARISR_reasm_release(&reasm, &message);
+        ARISR_reasm_destroy(&reasm);
+        LOG_INFO("[TEST PASSED] Fragments round trip");
+
+        // Too small a buffer writes nothing but reports the size, bad sizes are refused
+        if (ARISR_proto_build_fragments(frag_frames, frag_offsets[3] - 1, &header, frag_payload, sizeof(frag_payload),
+                                        ARISR_PROTO_MAX_FRAGMENT_SIZE, frag_offsets, ARISR_PROTO_MAX_FRAGMENTS, &frag_count, key) != kARISR_ERR_BUFFER_OVERFLOW ||
+            frag_offsets[frag_count] != frag_offsets[frag_count - 1] + (ARISR_UINT32)(ARISR_PROTO_MIN_FRAME_SIZE + ARISR_CTRL2_SECTION_SIZE + 944 + ARISR_CRC_SIZE) ||
+            ARISR_proto_build_fragments(frag_frames, sizeof(frag_frames), &header, frag_payload, sizeof(frag_payload),
+                                        ARISR_PROTO_MAX_FRAGMENT_SIZE + 1, frag_offsets, ARISR_PROTO_MAX_FRAGMENTS, &frag_count, key) != kARISR_ERR_INVALID_ARGUMENT ||
+            ARISR_proto_build_fragments(frag_frames, sizeof(frag_frames), &header, frag_payload, sizeof(frag_payload),
+                                        ARISR_PROTO_MAX_FRAGMENT_SIZE, frag_offsets, 2, &frag_count, key) != kARISR_ERR_INVALID_ARGUMENT ||
+            ARISR_proto_build_fragments(frag_frames, sizeof(frag_frames), &header, frag_payload, sizeof(frag_payload),
+                                        64, frag_offsets, ARISR_PROTO_MAX_FRAGMENTS, &frag_count, key) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED FRAGMENT ARGUMENTS");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Fragment arguments");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start duplicate suppression -------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 dedup_payload[100];
+        static ARISR_UINT8 dedup_frame[ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 dedup_broken[ARISR_PROTO_MAX_FRAME_SIZE];
+        ARISR_UINT32 dedup_length;
+        ARISR_CHUNK header, parsed;
+        ARISR_DEDUP dedup;
+
+        memset(dedup_payload, 0x5A, sizeof(dedup_payload));
+        memset(&header, 0, sizeof(header));
+        memcpy(header.id, id, ARISR_PROTO_ID_SIZE);
+        memcpy(header.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+        memset(header.origin, 0xD4, ARISR_ADDRESS_SIZE);
+        header.ctrl.identifier = 3;
+        header.ctrl.sequence = 1;
+        header.ctrl.more_header = 1;
+        header.ctrl2.data_length = sizeof(dedup_payload);
+        header.data = dedup_payload;
+
+        if ((err = ARISR_proto_build_into(dedup_frame, sizeof(dedup_frame), &dedup_length, &header, key)) != kARISR_OK ||
+            (err = ARISR_dedup_create(&dedup, 64, 100, NULL)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DEDUP SETUP WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // A copy with a broken data CRC is not recorded, the good copy still goes through
+        memcpy(dedup_broken, dedup_frame, dedup_length);
+        dedup_broken[dedup_length - ARISR_PROTO_ID_SIZE - ARISR_CRC_SIZE - 1] ^= 0x01;
+        if ((err = ARISR_dedup_parse_len_ctx(&dedup, 10, &parsed, dedup_broken, dedup_length, &key_ctx, id)) != kARISR_ERR_NOT_SAME_CRC_DATA ||
+            (err = ARISR_dedup_parse_len_ctx(&dedup, 10, &parsed, dedup_frame, dedup_length, &key_ctx, id)) != kARISR_OK ||
+            parsed.ctrl2.data_length != sizeof(dedup_payload) || memcmp(parsed.data, dedup_payload, sizeof(dedup_payload)) != 0) {
+            LOG_ERROR("TEST FAILED DEDUP FIRST COPY WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        ARISR_proto_chunk_clean(&parsed);
+
+        // Copies inside the window stop before the data section, later ones are new again
+        if ((err = ARISR_dedup_parse_len_ctx(&dedup, 109, &parsed, dedup_frame, dedup_length, &key_ctx, id)) != kARISR_ERR_DUPLICATE ||
+            parsed.data != NULL || dedup.duplicates != 1 ||
+            (err = ARISR_dedup_parse_len_ctx(&dedup, 110, &parsed, dedup_frame, dedup_length, &key_ctx, id)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DEDUP WINDOW WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        ARISR_proto_chunk_clean(&parsed);
+        LOG_INFO("[TEST PASSED] Duplicates dropped after the header CRC");
+
+        // Each field of the key tells frames apart
+        if (ARISR_dedup_check(&dedup, &header, 120) != kARISR_OK || ARISR_dedup_check(&dedup, &header, 121) != kARISR_ERR_DUPLICATE) {
+            LOG_ERROR("TEST FAILED DEDUP CHECK");
+            return -1;
+        }
+        header.ctrl.sequence = 2;
+        if (ARISR_dedup_check(&dedup, &header, 122) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DEDUP SEQUENCE");
+            return -1;
+        }
+        header.ctrl.identifier = 4;
+        if (ARISR_dedup_check(&dedup, &header, 123) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DEDUP IDENTIFIER");
+            return -1;
+        }
+        header.origin[5] = 0xD5;
+        if (ARISR_dedup_check(&dedup, &header, 124) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DEDUP ORIGIN");
+            return -1;
+        }
+        header.crc_header[1] = 0x01;
+        if (ARISR_dedup_check(&dedup, &header, 125) != kARISR_OK ||
+            ARISR_dedup_create(&dedup, 64, 0, NULL) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED DEDUP CRC");
+            return -1;
+        }
+        ARISR_dedup_clear(&dedup);
+        if (ARISR_dedup_check(&dedup, &header, 126) != kARISR_OK || ARISR_dedup_check(&dedup, &header, 127) != kARISR_ERR_DUPLICATE) {
+            LOG_ERROR("TEST FAILED DEDUP CLEAR");
+            return -1;
+        }
+        ARISR_dedup_destroy(&dedup);
+        LOG_INFO("[TEST PASSED] Duplicate keys");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start destination filtering -------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 addr_frame[ARISR_PROTO_MAX_FRAME_SIZE];
+        ARISR_UINT8 addr_payload[40];
+        ARISR_UINT48 addr_b[3];
+        ARISR_UINT8 address[ARISR_ADDRESS_SIZE];
+        ARISR_UINT32 addr_length, n;
+        ARISR_CHUNK header, parsed;
+        ARISR_ADDR_SET set;
+
+        if ((err = ARISR_addr_set_create(&set, 3000, NULL)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED ADDRESS SET CREATE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // Every even address 00:00:00:00:xx:xx, 3000 of them
+        memset(address, 0, sizeof(address));
+        for (n = 0; n < 3000; n++) {
+            address[4] = (ARISR_UINT8)((2 * n) >> 8);
+            address[5] = (ARISR_UINT8)(2 * n);
+            if ((err = ARISR_addr_set_insert(&set, address)) != kARISR_OK) {
+                LOG_ERROR("TEST FAILED ADDRESS SET INSERT %u WITH ERROR = %d (%s)", n, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+        }
+        address[5] = 0x02;
+        address[4] = 0x00;
+        if (ARISR_addr_set_insert(&set, address) != kARISR_OK || set.count != 3000) {
+            LOG_ERROR("TEST FAILED ADDRESS SET REINSERT count = %u", set.count);
+            return -1;
+        }
+        address[5] = 0x01;
+        if (ARISR_addr_set_insert(&set, address) != kARISR_ERR_BUFFER_OVERFLOW) {
+            LOG_ERROR("TEST FAILED ADDRESS SET FULL");
+            return -1;
+        }
+        for (n = 0; n < 6000; n++) {
+            address[4] = (ARISR_UINT8)(n >> 8);
+            address[5] = (ARISR_UINT8)n;
+            if (ARISR_addr_set_contains(&set, address) != ((n & 1) == 0)) {
+                LOG_ERROR("TEST FAILED ADDRESS SET CONTAINS %u", n);
+                return -1;
+            }
+        }
+        LOG_INFO("[TEST PASSED] Address set lookups");
+
+        // Relayed frame: A and the B addresses are odd, only C (when present) is in the set
+        memset(addr_payload, 0x33, sizeof(addr_payload));
+        memset(addr_b, 0, sizeof(addr_b));
+        memset(&header, 0, sizeof(header));
+        memcpy(header.id, id, ARISR_PROTO_ID_SIZE);
+        memcpy(header.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+        header.destinationA[5] = 0x01;
+        addr_b[0][5] = 0x03;
+        addr_b[1][5] = 0x05;
+        addr_b[2][5] = 0x07;
+        header.destinationsB = addr_b;
+        header.destinationC[5] = 0x08;
+        header.ctrl.destinations = 3;
+        header.ctrl.from = 1;
+        header.ctrl.more_header = 1;
+        header.ctrl2.data_length = sizeof(addr_payload);
+        header.data = addr_payload;
+
+        if ((err = ARISR_proto_build_into(addr_frame, sizeof(addr_frame), &addr_length, &header, key)) != kARISR_OK ||
+            (err = ARISR_addr_set_match_raw(&set, addr_frame, addr_length)) != kARISR_OK ||
+            (err = ARISR_proto_parse_len_filtered_ctx(&parsed, addr_frame, addr_length, &key_ctx, id, ARISR_addr_set_filter, &set)) != kARISR_OK ||
+            memcmp(parsed.data, addr_payload, sizeof(addr_payload)) != 0) {
+            LOG_ERROR("TEST FAILED ADDRESSED FRAME WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        ARISR_proto_chunk_clean(&parsed);
+
+        // Same addresses without the relay section: nothing is for us
+        header.ctrl.from = 0;
+        if ((err = ARISR_proto_build_into(addr_frame, sizeof(addr_frame), &addr_length, &header, key)) != kARISR_OK ||
+            (err = ARISR_addr_set_match_raw(&set, addr_frame, addr_length)) != kARISR_ERR_NOT_ADDRESSED ||
+            (err = ARISR_proto_parse_len_filtered_ctx(&parsed, addr_frame, addr_length, &key_ctx, id, ARISR_addr_set_filter, &set)) != kARISR_ERR_NOT_ADDRESSED ||
+            parsed.data != NULL || parsed.destinationsB != NULL ||
+            ARISR_addr_set_match_raw(&set, addr_frame, ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE + 2 * ARISR_ADDRESS_SIZE) != kARISR_ERR_INVALID_LENGTH) {
+            LOG_ERROR("TEST FAILED NOT ADDRESSED FRAME WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // A match in the B addresses
+        addr_b[1][5] = 0x06;
+        if ((err = ARISR_proto_build_into(addr_frame, sizeof(addr_frame), &addr_length, &header, key)) != kARISR_OK ||
+            (err = ARISR_addr_set_match_raw(&set, addr_frame, addr_length)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED DESTINATION B MATCH WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        ARISR_addr_set_destroy(&set);
+        LOG_INFO("[TEST PASSED] Frames filtered by destination");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start relay rewrite ---------------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 relay_frame[ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 relay_forwarded[ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 relay_expected[ARISR_PROTO_MAX_FRAME_SIZE];
+        const ARISR_UINT8 relay_first[ARISR_ADDRESS_SIZE] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+        const ARISR_UINT8 relay_second[ARISR_ADDRESS_SIZE] = { 0x02, 0x66, 0x77, 0x88, 0x99, 0xAA };
+        ARISR_UINT8 relay_payload[70];
+        ARISR_UINT48 relay_b[2];
+        ARISR_UINT32 relay_length, forwarded_length, expected_length;
+        ARISR_CHUNK header;
+
+        memset(relay_payload, 0x4C, sizeof(relay_payload));
+        memset(relay_b, 0x6E, sizeof(relay_b));
+        memset(&header, 0, sizeof(header));
+        memcpy(header.id, id, ARISR_PROTO_ID_SIZE);
+        memcpy(header.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+        memset(header.origin, 0x01, ARISR_ADDRESS_SIZE);
+        memset(header.destinationA, 0x0A, ARISR_ADDRESS_SIZE);
+        header.destinationsB = relay_b;
+        header.ctrl.destinations = 2;
+        header.ctrl.identifier = 12;
+        header.ctrl.more_header = 1;
+        header.ctrl2.data_length = sizeof(relay_payload);
+        header.data = relay_payload;
+
+        if ((err = ARISR_proto_build_into(relay_frame, sizeof(relay_frame), &relay_length, &header, key)) != kARISR_OK) {
+            LOG_ERROR("TEST FAILED RELAY BUILD WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // First hop inserts destination C, the result is the frame the sender would build as relayed
+        header.ctrl.from = 1;
+        memcpy(header.destinationC, relay_first, ARISR_ADDRESS_SIZE);
+        if ((err = ARISR_proto_relay_rewrite(relay_forwarded, sizeof(relay_forwarded), &forwarded_length, relay_frame, relay_length, id, relay_first)) != kARISR_OK ||
+            (err = ARISR_proto_build_into(relay_expected, sizeof(relay_expected), &expected_length, &header, key)) != kARISR_OK ||
+            forwarded_length != relay_length + ARISR_ADDRESS_SIZE || forwarded_length != expected_length ||
+            memcmp(relay_forwarded, relay_expected, expected_length) != 0) {
+            LOG_ERROR("TEST FAILED RELAY INSERT WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+
+        // Second hop replaces it, in place
+        memcpy(header.destinationC, relay_second, ARISR_ADDRESS_SIZE);
+        if ((err = ARISR_proto_relay_rewrite(relay_forwarded, sizeof(relay_forwarded), &forwarded_length, relay_forwarded, forwarded_length, id, relay_second)) != kARISR_OK ||
+            (err = ARISR_proto_build_into(relay_expected, sizeof(relay_expected), &expected_length, &header, key)) != kARISR_OK ||
+            forwarded_length != expected_length || memcmp(relay_forwarded, relay_expected, expected_length) != 0) {
+            LOG_ERROR("TEST FAILED RELAY REPLACE WITH ERROR = %d (%s)", err, ARISR_ERR_NAMES[err]);
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Relay rewrite matches a rebuilt frame");
+
+        // Too small or partly overlapping buffers, and a damaged header is never forwarded
+        if (ARISR_proto_relay_rewrite(relay_forwarded, relay_length, &forwarded_length, relay_frame, relay_length, id, relay_first) != kARISR_ERR_BUFFER_OVERFLOW ||
+            forwarded_length != relay_length + ARISR_ADDRESS_SIZE ||
+            ARISR_proto_relay_rewrite(relay_forwarded + 1, sizeof(relay_forwarded) - 1, &expected_length, relay_forwarded, forwarded_length, id, relay_first) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED RELAY OVERFLOW");
+            return -1;
+        }
+        relay_frame[ARISR_PROTO_CRYPT_SIZE + ARISR_CTRL_SECTION_SIZE] ^= 0x80;
+        if (ARISR_proto_relay_rewrite(relay_forwarded, sizeof(relay_forwarded), &forwarded_length, relay_frame, relay_length, id, relay_first) != kARISR_ERR_NOT_SAME_CRC_HEADER ||
+            ARISR_proto_relay_rewrite(relay_forwarded, sizeof(relay_forwarded), &forwarded_length, relay_frame, relay_length - 1, id, relay_first) != kARISR_ERR_INVALID_LENGTH) {
+            LOG_ERROR("TEST FAILED RELAY DAMAGED HEADER");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Relay rewrite arguments");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start fused AES and CRC -----------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 fused_plain[ARISR_PROTO_MAX_DATA_LENGTH];
+        static ARISR_UINT8 fused_cipher[ARISR_PROTO_MAX_DATA_LENGTH];
+        static ARISR_UINT8 fused_out[ARISR_PROTO_MAX_DATA_LENGTH];
+        static ARISR_UINT8 fused_ref[ARISR_PROTO_MAX_DATA_LENGTH];
+        const ARISR_UINT32 fused_lengths[] = { 1, 15, 16, 17, ARISR_AES_CRC_STRIP - 1, ARISR_AES_CRC_STRIP, ARISR_AES_CRC_STRIP + 1,
+                                               1000, ARISR_PROTO_MAX_FRAGMENT_SIZE };
+        ARISR_CRC16_CTX fused_crc;
+        ARISR_UINT32 fused_length, ref_length, n;
+
+        for (n = 0; n < sizeof(fused_plain); n++) {
+            fused_plain[n] = (ARISR_UINT8)(n * 31 + 7);
+        }
+
+        for (n = 0; n < sizeof(fused_lengths) / sizeof(fused_lengths[0]); n++) {
+            // Same ciphertext and CRC as the two separate passes
+            ARISR_crypt_crc16_init(&fused_crc);
+            if ((err = ARISR_aes_data_encrypt_crc_into_ctx(&key_ctx, fused_plain, fused_lengths[n], fused_cipher, sizeof(fused_cipher), &fused_length, &fused_crc)) != kARISR_OK ||
+                (err = ARISR_aes_data_encrypt_into_ctx(&key_ctx, fused_plain, fused_lengths[n], fused_ref, sizeof(fused_ref), &ref_length)) != kARISR_OK ||
+                fused_length != ref_length || memcmp(fused_cipher, fused_ref, ref_length) != 0 ||
+                ARISR_crypt_crc16_final(&fused_crc) != ARISR_crypt_crc16_calculate(fused_ref, ref_length)) {
+                LOG_ERROR("TEST FAILED FUSED ENCRYPT LENGTH %u WITH ERROR = %d (%s)", fused_lengths[n], err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            // Back to the plaintext, in place, with the same CRC
+            ARISR_crypt_crc16_init(&fused_crc);
+            memcpy(fused_out, fused_cipher, fused_length);
+            if ((err = ARISR_aes_data_decrypt_crc_into_ctx(&key_ctx, fused_out, fused_length, fused_out, sizeof(fused_out), &ref_length, &fused_crc)) != kARISR_OK ||
+                ref_length != fused_lengths[n] || memcmp(fused_out, fused_plain, ref_length) != 0 ||
+                ARISR_crypt_crc16_final(&fused_crc) != ARISR_crypt_crc16_calculate(fused_cipher, fused_length)) {
+                LOG_ERROR("TEST FAILED FUSED DECRYPT LENGTH %u WITH ERROR = %d (%s)", fused_lengths[n], err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+        }
+
+        // Encrypting in place gives the same result
+        memcpy(fused_out, fused_plain, 1000);
+        ARISR_crypt_crc16_init(&fused_crc);
+        if (ARISR_aes_data_encrypt_crc_into_ctx(&key_ctx, fused_out, 1000, fused_out, sizeof(fused_out), &fused_length, &fused_crc) != kARISR_OK ||
+            ARISR_aes_data_encrypt_into_ctx(&key_ctx, fused_plain, 1000, fused_ref, sizeof(fused_ref), &ref_length) != kARISR_OK ||
+            memcmp(fused_out, fused_ref, ref_length) != 0) {
+            LOG_ERROR("TEST FAILED FUSED ENCRYPT IN PLACE");
+            return -1;
+        }
+
+        // A broken last block fails the padding, and the CRC still covers every byte
+        fused_ref[ref_length - 1] ^= 0x01;
+        ARISR_crypt_crc16_init(&fused_crc);
+        if (ARISR_aes_data_decrypt_crc_into_ctx(&key_ctx, fused_ref, ref_length, fused_out, sizeof(fused_out), &fused_length, &fused_crc) != kARISR_ERR_INVALID_PADDING ||
+            ARISR_crypt_crc16_final(&fused_crc) != ARISR_crypt_crc16_calculate(fused_ref, ref_length)) {
+            LOG_ERROR("TEST FAILED FUSED DECRYPT PADDING");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Fused AES and CRC kernels (strip = %d)", ARISR_AES_CRC_STRIP);
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start scatter-gather build --------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 iov_expected[ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 iov_joined[ARISR_PROTO_MAX_FRAME_SIZE];
+        static ARISR_UINT8 iov_cipher[300 + ARISR_AES128_BLOCK_SIZE];
+        static ARISR_UINT48 iov_b[100];
+        ARISR_UINT8 iov_payload[300];
+        ARISR_IOVEC iov[ARISR_PROTO_IOV_MAX];
+        ARISR_FRAME_SCRATCH scratch;
+        ARISR_UINT32 iov_count, iov_length, expected_length, joined, n, k;
+        ARISR_CHUNK header;
+
+        for (n = 0; n < sizeof(iov_payload); n++) {
+            iov_payload[n] = (ARISR_UINT8)(n ^ 0xA5);
+        }
+        for (n = 0; n < 100; n++) {
+            memset(iov_b[n], (int)n, ARISR_ADDRESS_SIZE);
+        }
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.id, id, ARISR_PROTO_ID_SIZE);
+        memcpy(header.aris, ARISR_PROTO_ARIS_TEXT, ARISR_PROTO_ARIS_SIZE);
+        memset(header.origin, 0x0F, ARISR_ADDRESS_SIZE);
+        memset(header.destinationA, 0xF0, ARISR_ADDRESS_SIZE);
+        memset(header.destinationC, 0x3C, ARISR_ADDRESS_SIZE);
+        header.destinationsB = iov_b;
+
+        // Full frame, frame without relay nor B list, frame without data
+        for (k = 0; k < 3; k++) {
+            header.ctrl.destinations = k == 0 ? 100 : 0;
+            header.ctrl.from = k == 0;
+            header.ctrl.more_header = k < 2;
+            header.ctrl2.data_length = k < 2 ? sizeof(iov_payload) : 0;
+            header.data = k < 2 ? iov_payload : NULL;
+
+            if ((err = ARISR_proto_build_iov(iov, &iov_count, &iov_length, &scratch, iov_cipher, sizeof(iov_cipher), &header, key)) != kARISR_OK ||
+                (err = ARISR_proto_build_into(iov_expected, sizeof(iov_expected), &expected_length, &header, key)) != kARISR_OK) {
+                LOG_ERROR("TEST FAILED IOV BUILD %u WITH ERROR = %d (%s)", k, err, ARISR_ERR_NAMES[err]);
+                return -1;
+            }
+
+            // What writev would send
+            for (n = 0, joined = 0; n < iov_count; n++) {
+                memcpy(iov_joined + joined, iov[n].base, iov[n].length);
+                joined += iov[n].length;
+            }
+            if (iov_count != (ARISR_UINT32)(k == 0 ? 5 : k == 1 ? 4 : 3) || joined != iov_length || iov_length != expected_length ||
+                memcmp(iov_joined, iov_expected, expected_length) != 0 || (k == 0 && iov[1].base != (const ARISR_UINT8 *)iov_b)) {
+                LOG_ERROR("TEST FAILED IOV FRAME %u count = %u length = %u expected = %u", k, iov_count, joined, expected_length);
+                return -1;
+            }
+        }
+        LOG_INFO("[TEST PASSED] Scatter-gather frames match the contiguous build");
+
+        header.ctrl.more_header = 1;
+        header.ctrl2.data_length = sizeof(iov_payload);
+        header.data = iov_payload;
+        if (ARISR_proto_build_iov(iov, &iov_count, &iov_length, &scratch, iov_cipher, sizeof(iov_payload), &header, key) != kARISR_ERR_BUFFER_OVERFLOW ||
+            ARISR_proto_build_iov(iov, &iov_count, &iov_length, &scratch, NULL, 0, &header, key) != kARISR_ERR_INVALID_ARGUMENT) {
+            LOG_ERROR("TEST FAILED IOV ARGUMENTS");
+            return -1;
+        }
+        LOG_INFO("[TEST PASSED] Scatter-gather arguments");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("------- Start AES-128 ECB vectors ---------");
+    LOG_INFO("-------------------------------------------");
+
+    // NIST SP 800-38A F.1.1 / F.1.2, checks whichever AES backend is compiled in
+    {
+        static const ARISR_UINT8 aes_key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+        static const ARISR_UINT8 aes_plain[32] = {
+            0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+            0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51 };
+        static const ARISR_UINT8 aes_cipher[32] = {
+            0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+            0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf };
+        ARISR_UINT8 aes_block[32];
+        struct AES_ctx aes_ctx;
+
+        AES_init_ctx(&aes_ctx, aes_key);
+        memcpy(aes_block, aes_plain, sizeof(aes_block));
+        AES_ECB_encrypt(&aes_ctx, aes_block);
+        AES_ECB_encrypt(&aes_ctx, aes_block + AES_BLOCKLEN);
+        if (memcmp(aes_block, aes_cipher, sizeof(aes_block)) != 0) {
+            LOG_ERROR("TEST FAILED AES ECB ENCRYPT VECTOR MISMATCH");
+            return -1;
+        }
+
+        AES_ECB_decrypt(&aes_ctx, aes_block);
+        AES_ECB_decrypt(&aes_ctx, aes_block + AES_BLOCKLEN);
+        if (memcmp(aes_block, aes_plain, sizeof(aes_block)) != 0) {
+            LOG_ERROR("TEST FAILED AES ECB DECRYPT VECTOR MISMATCH");
+            return -1;
+        }
+
+        LOG_INFO("[TEST PASSED] AES-128 ECB vectors (T-table = %d)", AES_TTABLE);
+
+        // Multi-block functions (pipelined when AES-NI is available) against one block at a time,
+        // 131 blocks to cover the 8-block main loop and the tail
+        static ARISR_UINT8 aes_multi[131 * AES_BLOCKLEN], aes_single[131 * AES_BLOCKLEN];
+        size_t b;
+
+        for (b = 0; b < sizeof(aes_multi); b++) {
+            aes_multi[b] = (ARISR_UINT8)(b * 7 + 3);
+        }
+        memcpy(aes_single, aes_multi, sizeof(aes_single));
+
+        AES_ECB_encrypt_blocks(&aes_ctx, aes_multi, sizeof(aes_multi));
+        for (b = 0; b < sizeof(aes_single); b += AES_BLOCKLEN) {
+            AES_ECB_encrypt(&aes_ctx, aes_single + b);
+        }
+        if (memcmp(aes_multi, aes_single, sizeof(aes_multi)) != 0) {
+            LOG_ERROR("TEST FAILED AES ECB ENCRYPT BLOCKS MISMATCH");
+            return -1;
+        }
+
+        AES_ECB_decrypt_blocks(&aes_ctx, aes_multi, sizeof(aes_multi));
+        for (b = 0; b < sizeof(aes_single); b += AES_BLOCKLEN) {
+            AES_ECB_decrypt(&aes_ctx, aes_single + b);
+        }
+        if (memcmp(aes_multi, aes_single, sizeof(aes_multi)) != 0 || aes_multi[5] != (ARISR_UINT8)(5 * 7 + 3)) {
+            LOG_ERROR("TEST FAILED AES ECB DECRYPT BLOCKS MISMATCH");
+            return -1;
+        }
+
+        LOG_INFO("[TEST PASSED] AES-128 ECB blocks (AES-NI = %d)", AES_NI);
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
+    LOG_INFO("--------------  TEST UNIT  ----------------");
+    LOG_INFO("--------- Start CRC-16 engines ------------");
+    LOG_INFO("-------------------------------------------");
+
+    {
+        static ARISR_UINT8 crc_data[2 * ARISR_PROTO_MAX_DATA_LENGTH + 64];
+        ARISR_UINT32 crc_len, crc_off, seed = 12345;
+        ARISR_UINT16 crc_expected, crc_got;
+
+        // Standard check value
+        if ((crc_got = ARISR_crypt_crc16_calculate((const ARISR_UINT8 *)"123456789", 9)) != 0x29B1) {
+            LOG_ERROR("TEST FAILED CRC CHECK VALUE = 0x%04X AND EXPECTED = 0x29B1", crc_got);
+            return -1;
+        }
+
+        for (crc_len = 0; crc_len < sizeof(crc_data); crc_len++) {
+            seed = seed * 1103515245 + 12345;
+            crc_data[crc_len] = (ARISR_UINT8)(seed >> 16);
+        }
+
+        // Every length around the slicing and folding boundaries, at unaligned offsets, then the big ones
+        for (crc_len = 0; crc_len <= 300 || crc_len <= sizeof(crc_data) - 64; crc_len += (crc_len < 300) ? 1 : 251) {
+            crc_off = crc_len % 7;
+            crc_expected = crc16Reference(crc_data + crc_off, crc_len);
+            crc_got = ARISR_crypt_crc16_calculate(crc_data + crc_off, crc_len);
+            if (crc_got != crc_expected) {
+                LOG_ERROR("TEST FAILED CRC LENGTH %u = 0x%04X AND EXPECTED = 0x%04X", crc_len, crc_got, crc_expected);
+                return -1;
+            }
+        }
+
+        LOG_INFO("[TEST PASSED] CRC-16 (slices = %d, clmul = %d)", ARISR_CRC16_SLICES, ARISR_CRC16_CLMUL);
+
+        // Split at every kind of boundary: streamed in two uneven pieces, and combined from two separate CRCs
+        {
+            const ARISR_UINT32 crc_splits[] = { 0, 1, 7, 15, 16, 63, 64, 65, 200, 1000, 2039, 2040 };
+            ARISR_CRC16_CTX crc_ctx;
+            ARISR_UINT32 n, crc_step;
+
+            crc_len = 2040;
+            crc_expected = ARISR_crypt_crc16_calculate(crc_data, crc_len);
+
+            for (n = 0; n < sizeof(crc_splits) / sizeof(crc_splits[0]); n++) {
+                ARISR_crypt_crc16_init(&crc_ctx);
+                ARISR_crypt_crc16_update(&crc_ctx, crc_data, crc_splits[n]);
+                ARISR_crypt_crc16_update(&crc_ctx, crc_data + crc_splits[n], crc_len - crc_splits[n]);
+                crc_got = ARISR_crypt_crc16_combine(ARISR_crypt_crc16_calculate(crc_data, crc_splits[n]),
+                                                    ARISR_crypt_crc16_calculate(crc_data + crc_splits[n], crc_len - crc_splits[n]),
+                                                    crc_len - crc_splits[n]);
+                if (ARISR_crypt_crc16_final(&crc_ctx) != crc_expected || crc_got != crc_expected) {
+                    LOG_ERROR("TEST FAILED CRC SPLIT AT %u = 0x%04X / 0x%04X AND EXPECTED = 0x%04X", crc_splits[n],
+                              ARISR_crypt_crc16_final(&crc_ctx), crc_got, crc_expected);
+                    return -1;
+                }
+            }
+
+            // Many small pieces of growing size
+            ARISR_crypt_crc16_init(&crc_ctx);
+            for (crc_off = 0, crc_step = 1; crc_off < crc_len; crc_off += crc_step, crc_step = crc_step * 2 + 1) {
+                ARISR_crypt_crc16_update(&crc_ctx, crc_data + crc_off, crc_off + crc_step > crc_len ? crc_len - crc_off : crc_step);
+            }
+            if (ARISR_crypt_crc16_final(&crc_ctx) != crc_expected) {
+                LOG_ERROR("TEST FAILED CRC STREAM = 0x%04X AND EXPECTED = 0x%04X", ARISR_crypt_crc16_final(&crc_ctx), crc_expected);
+                return -1;
+            }
+        }
+
+        LOG_INFO("[TEST PASSED] CRC-16 streaming and combine");
+    }
+
+    LOG_INFO("-------------------------------------------");
+    LOG_INFO("");
+    LOG_INFO("-------------------------------------------");
+
     LOG_INFO("--------------  TEST UNIT  ----------------");
     LOG_INFO("-------------- END OF TEST ----------------");
     LOG_INFO("-------------------------------------------");